@@ -0,0 +1,174 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "option.hpp"
+#include "ref.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+namespace better {
+
+// Option-returning lookups over standard containers.
+// Hits are returned as Option<Ref<...>>, which is a single pointer.
+// Const containers give Ref<const T>; containers are taken by lvalue
+// reference only, so references into temporaries do not compile
+
+namespace detail {
+
+template <class It>
+using IterRef = Ref<std::remove_reference_t<std::iter_reference_t<It>>>;
+
+template <class It>
+Option<IterRef<It>> ref_at(It it) noexcept {
+    return {Some, IterRef<It>{*it}};
+}
+
+} // namespace detail
+
+// Associative lookup: std::map, std::unordered_map and alike.
+// Transparent comparators and hashers make `key` heterogeneous:
+// no temporary key is constructed
+template <class Map, class Key>
+    requires requires(Map& map, const Key& key) {
+        map.find(key) == map.end();
+        map.find(key)->second;
+    }
+auto get(Map& map, const Key& key) noexcept(noexcept(map.find(key))) {
+    using Value = std::remove_reference_t<decltype((map.find(key)->second))>;
+    const auto it = map.find(key);
+    if (it == map.end()) {
+        return Option<Ref<Value>>{None};
+    }
+    return Option<Ref<Value>>{Some, Ref<Value>{it->second}};
+}
+
+// Bounds checked element access for random access containers
+template <std::ranges::random_access_range Seq>
+auto at(Seq& seq, std::size_t i) noexcept {
+    using R = detail::IterRef<std::ranges::iterator_t<Seq>>;
+    if (i < std::ranges::size(seq)) {
+        return detail::ref_at(std::ranges::begin(seq) +
+                              static_cast<std::ptrdiff_t>(i));
+    }
+    return Option<R>{None};
+}
+
+// span is a view: temporaries are fine, constness comes from T
+template <class T, std::size_t N>
+Option<Ref<T>> at(std::span<T, N> seq, std::size_t i) noexcept {
+    if (i < seq.size()) {
+        return {Some, Ref<T>{seq[i]}};
+    }
+    return None;
+}
+
+template <std::ranges::forward_range C>
+auto front(C& c) noexcept {
+    using R = detail::IterRef<std::ranges::iterator_t<C>>;
+    if (std::ranges::empty(c)) {
+        return Option<R>{None};
+    }
+    return detail::ref_at(std::ranges::begin(c));
+}
+
+template <class T, std::size_t N>
+Option<Ref<T>> front(std::span<T, N> seq) noexcept {
+    return at(seq, 0);
+}
+
+template <std::ranges::bidirectional_range C>
+    requires std::ranges::common_range<C>
+auto back(C& c) noexcept {
+    using R = detail::IterRef<std::ranges::iterator_t<C>>;
+    if (std::ranges::empty(c)) {
+        return Option<R>{None};
+    }
+    return detail::ref_at(std::prev(std::ranges::end(c)));
+}
+
+template <class T, std::size_t N>
+Option<Ref<T>> back(std::span<T, N> seq) noexcept {
+    if (seq.empty()) {
+        return None;
+    }
+    return {Some, Ref<T>{seq.back()}};
+}
+
+// Removes the last element and moves it out
+template <class C>
+    requires requires(C& c) {
+        c.back();
+        c.pop_back();
+        c.empty();
+    }
+auto pop_back(C& c) {
+    using T = typename C::value_type;
+    if (c.empty()) {
+        return Option<T>{None};
+    }
+    Option<T> last{Some, std::move(c.back())};
+    c.pop_back();
+    return last;
+}
+
+// First element equal to `value`
+template <std::ranges::forward_range R, class U>
+auto find(R& range, const U& value) {
+    using Res = detail::IterRef<std::ranges::iterator_t<R>>;
+    const auto it = std::ranges::find(range, value);
+    if (it == std::ranges::end(range)) {
+        return Option<Res>{None};
+    }
+    return detail::ref_at(it);
+}
+
+template <std::ranges::forward_range R, class Pred>
+auto find_if(R& range, Pred&& pred) {
+    using Res = detail::IterRef<std::ranges::iterator_t<R>>;
+    const auto it = std::ranges::find_if(range, std::forward<Pred>(pred));
+    if (it == std::ranges::end(range)) {
+        return Option<Res>{None};
+    }
+    return detail::ref_at(it);
+}
+
+// Element equivalent to `key` in a range sorted by `comp`.
+// `key` may be of any type `comp` accepts on both sides
+template <std::ranges::forward_range R, class Key, class Comp = std::less<>>
+auto binary_find(R& sorted, const Key& key, Comp comp = {}) {
+    using Res = detail::IterRef<std::ranges::iterator_t<R>>;
+    const auto it = std::ranges::lower_bound(sorted, key, comp);
+    if (it == std::ranges::end(sorted) || comp(key, *it)) {
+        return Option<Res>{None};
+    }
+    return detail::ref_at(it);
+}
+
+} // namespace better
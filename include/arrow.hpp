@@ -0,0 +1,364 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "column_view.hpp"
+#include "option.hpp"
+#include "ref.hpp"
+#include "result.hpp"
+#include "void.hpp"
+
+#include "storage/enum.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+
+// Arrow C Data Interface, as specified by Apache Arrow.
+// Guarded the same way as in arrow/c/abi.h, so both can be included
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+    void (*release)(struct ArrowSchema*);
+    void* private_data;
+};
+
+struct ArrowArray {
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+    void (*release)(struct ArrowArray*);
+    void* private_data;
+};
+
+#endif // ARROW_C_DATA_INTERFACE
+
+namespace better::arrow {
+
+// Arrow format string of a primitive type.
+// ColumnView already has the Arrow layout for these types:
+// LSB-first validity bitmap and packed values
+template <class T>
+struct format {};
+
+template <>
+struct format<std::int8_t> {
+    static constexpr const char* value = "c";
+};
+
+template <>
+struct format<std::uint8_t> {
+    static constexpr const char* value = "C";
+};
+
+template <>
+struct format<std::int16_t> {
+    static constexpr const char* value = "s";
+};
+
+template <>
+struct format<std::uint16_t> {
+    static constexpr const char* value = "S";
+};
+
+template <>
+struct format<std::int32_t> {
+    static constexpr const char* value = "i";
+};
+
+template <>
+struct format<std::uint32_t> {
+    static constexpr const char* value = "I";
+};
+
+template <>
+struct format<std::int64_t> {
+    static constexpr const char* value = "l";
+};
+
+template <>
+struct format<std::uint64_t> {
+    static constexpr const char* value = "L";
+};
+
+template <>
+struct format<float> {
+    static constexpr const char* value = "f";
+};
+
+template <>
+struct format<double> {
+    static constexpr const char* value = "g";
+};
+
+template <class T>
+concept Primitive = requires {
+    { format<T>::value } -> std::convertible_to<const char*>;
+};
+
+namespace detail {
+
+template <class Owner>
+struct ExportedArray {
+    Owner owner;
+    const void* buffers[2];
+
+    static void release(ArrowArray* array) {
+        delete static_cast<ExportedArray*>(array->private_data);
+        array->release = nullptr;
+    }
+};
+
+struct ExportedSchema {
+    std::string name;
+
+    static void release(ArrowSchema* schema) {
+        delete static_cast<ExportedSchema*>(schema->private_data);
+        schema->release = nullptr;
+    }
+};
+
+} // namespace detail
+
+// Describes a nullable column of T
+template <Primitive T>
+void export_schema(ArrowSchema* out, std::string name = {}) {
+    auto data = std::make_unique<detail::ExportedSchema>(std::move(name));
+    *out = ArrowSchema{
+        .format = format<T>::value,
+        .name = data->name.c_str(),
+        .metadata = nullptr,
+        .flags = ARROW_FLAG_NULLABLE,
+        .n_children = 0,
+        .children = nullptr,
+        .dictionary = nullptr,
+        .release = &detail::ExportedSchema::release,
+        .private_data = data.release(),
+    };
+}
+
+// Hands the column to an Arrow consumer without copying:
+// buffers point straight into `view` memory.
+// `owner` (e.g. ColumnReader or shared_ptr to the storage) is kept alive
+// until the consumer releases the array. With the default Void the caller
+// must keep the memory alive on its own
+template <Primitive T, class Owner = Void>
+void export_column(const ColumnView<T>& view, ArrowArray* out,
+                   Owner owner = {}) {
+    auto data = std::make_unique<detail::ExportedArray<Owner>>(
+        detail::ExportedArray<Owner>{
+            std::move(owner), {view.validity().data(), view.values().data()}});
+    *out = ArrowArray{
+        .length = static_cast<int64_t>(view.size()),
+        // unknown, consumers count it if they need to
+        .null_count = -1,
+        .offset = 0,
+        .n_buffers = 2,
+        .n_children = 0,
+        .buffers = data->buffers,
+        .children = nullptr,
+        .dictionary = nullptr,
+        .release = &detail::ExportedArray<Owner>::release,
+        .private_data = data.release(),
+    };
+}
+
+enum class ImportError : std::uint8_t {
+    // Array or schema was already released
+    Released,
+    // Schema format doesn't match T
+    FormatMismatch,
+    // Not a primitive array: wrong buffer count, children or dictionary
+    UnexpectedLayout,
+    // Values buffer is not aligned for T
+    Misaligned,
+};
+
+inline const char* message(ImportError err) noexcept {
+    switch (err) {
+    case ImportError::Released:
+        return "arrow array is released";
+    case ImportError::FormatMismatch:
+        return "arrow format doesn't match the column type";
+    case ImportError::UnexpectedLayout:
+        return "arrow array is not a primitive array";
+    case ImportError::Misaligned:
+        return "arrow values buffer is misaligned";
+    }
+    return "unknown arrow import error";
+}
+
+} // namespace better::arrow
+
+template <>
+struct better::enum_max<better::arrow::ImportError> {
+    static constexpr auto value = better::arrow::ImportError::Misaligned;
+};
+
+namespace better::arrow {
+
+// Read-only column of Option<Ref<const T>> over an imported Arrow array.
+// Owns the array and releases it on destruction
+template <Primitive T>
+struct ArrowColumn {
+    ArrowColumn(ArrowColumn&& other) noexcept : _array{other._array} {
+        other._array.release = nullptr;
+    }
+
+    ArrowColumn& operator=(ArrowColumn&& other) noexcept {
+        ArrowColumn tmp{std::move(other)};
+        std::swap(_array, tmp._array);
+        return *this;
+    }
+
+    ArrowColumn(const ArrowColumn&) = delete;
+    ArrowColumn& operator=(const ArrowColumn&) = delete;
+
+    ~ArrowColumn() {
+        if (_array.release != nullptr) {
+            _array.release(&_array);
+        }
+    }
+
+    std::size_t size() const noexcept {
+        return static_cast<std::size_t>(_array.length);
+    }
+
+    bool is_some(std::size_t i) const noexcept {
+        const auto validity =
+            static_cast<const std::uint8_t*>(_array.buffers[0]);
+        // no bitmap means no nulls
+        if (validity == nullptr) {
+            return true;
+        }
+        const std::size_t bit = static_cast<std::size_t>(_array.offset) + i;
+        return (validity[bit / 8] >> (bit % 8)) & 1;
+    }
+
+    // None for nulls and for out of range indices
+    Option<Ref<const T>> get(std::size_t i) const noexcept {
+        if (i < size() && is_some(i)) {
+            return {Some, Ref{values()[i]}};
+        }
+        return None;
+    }
+
+    struct Iterator {
+        using iterator_concept = std::forward_iterator_tag;
+        using value_type = Option<Ref<const T>>;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+
+        value_type operator*() const noexcept { return _column->get(_index); }
+
+        Iterator& operator++() noexcept {
+            ++_index;
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            Iterator prev = *this;
+            ++_index;
+            return prev;
+        }
+
+        bool operator==(const Iterator& other) const noexcept {
+            return _index == other._index;
+        }
+
+      private:
+        friend struct ArrowColumn;
+
+        Iterator(const ArrowColumn* column, std::size_t index) noexcept
+            : _column{column}, _index{index} {}
+
+        const ArrowColumn* _column = nullptr;
+        std::size_t _index = 0;
+    };
+
+    Iterator begin() const noexcept { return Iterator{this, 0}; }
+    Iterator end() const noexcept { return Iterator{this, size()}; }
+
+  private:
+    template <Primitive U>
+    friend Result<ArrowColumn<U>, ImportError>
+    import_column(ArrowArray* array, const ArrowSchema& schema) noexcept;
+
+    explicit ArrowColumn(const ArrowArray& array) noexcept : _array{array} {}
+
+    const T* values() const noexcept {
+        return static_cast<const T*>(_array.buffers[1]) + _array.offset;
+    }
+
+    ArrowArray _array;
+};
+
+// Takes ownership of `array` if it is a primitive array of T:
+// `array` is marked released and the returned column releases it later.
+// On error `array` is left untouched and stays owned by the caller
+template <Primitive T>
+Result<ArrowColumn<T>, ImportError>
+import_column(ArrowArray* array, const ArrowSchema& schema) noexcept {
+    if (array->release == nullptr || schema.release == nullptr) {
+        return {Err, ImportError::Released};
+    }
+    if (std::strcmp(schema.format, format<T>::value) != 0) {
+        return {Err, ImportError::FormatMismatch};
+    }
+    if (array->n_buffers != 2 || array->n_children != 0 ||
+        array->dictionary != nullptr || array->offset < 0 ||
+        array->length < 0 ||
+        (array->buffers[1] == nullptr && array->length != 0)) {
+        return {Err, ImportError::UnexpectedLayout};
+    }
+    if (reinterpret_cast<std::uintptr_t>(array->buffers[1]) % alignof(T) !=
+        0) {
+        return {Err, ImportError::Misaligned};
+    }
+    ArrowColumn<T> column{*array};
+    array->release = nullptr;
+    return {Ok, std::move(column)};
+}
+
+} // namespace better::arrow
@@ -0,0 +1,115 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#ifdef __linux__
+#include <cerrno>
+#include <ctime>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace better::detail {
+
+// Blocking on a 32-bit atomic word, with a timed variant that
+// std::atomic::wait lacks. On Linux all of them are plain futex calls,
+// elsewhere wait/notify go to std::atomic and the timed wait polls.
+// Waiters and notifiers of one word must use these functions only
+
+#ifdef __linux__
+
+inline long futex(std::atomic<std::uint32_t>& word, int op,
+                  std::uint32_t value, const timespec* timeout) noexcept {
+    static_assert(sizeof(word) == sizeof(std::uint32_t));
+    return ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), op,
+                     value, timeout, nullptr, 0);
+}
+
+// Returns once word != old (or spuriously)
+inline void atomic_wait(std::atomic<std::uint32_t>& word,
+                        std::uint32_t old) noexcept {
+    futex(word, FUTEX_WAIT_PRIVATE, old, nullptr);
+}
+
+// Returns false if the timeout expired before word changed
+template <class Rep, class Period>
+bool atomic_wait_for(std::atomic<std::uint32_t>& word, std::uint32_t old,
+                     std::chrono::duration<Rep, Period> timeout) noexcept {
+    using namespace std::chrono;
+    const auto deadline = steady_clock::now() + timeout;
+    while (word.load(std::memory_order_acquire) == old) {
+        const auto left = deadline - steady_clock::now();
+        if (left <= steady_clock::duration::zero()) {
+            return false;
+        }
+        const auto ns = duration_cast<nanoseconds>(left).count();
+        const timespec ts{static_cast<std::time_t>(ns / 1'000'000'000),
+                          static_cast<long>(ns % 1'000'000'000)};
+        futex(word, FUTEX_WAIT_PRIVATE, old, &ts);
+    }
+    return true;
+}
+
+inline void atomic_notify_all(std::atomic<std::uint32_t>& word) noexcept {
+    futex(word, FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr);
+}
+
+#else
+
+inline void atomic_wait(std::atomic<std::uint32_t>& word,
+                        std::uint32_t old) noexcept {
+    word.wait(old, std::memory_order_acquire);
+}
+
+template <class Rep, class Period>
+bool atomic_wait_for(std::atomic<std::uint32_t>& word, std::uint32_t old,
+                     std::chrono::duration<Rep, Period> timeout) noexcept {
+    using namespace std::chrono;
+    const auto deadline = steady_clock::now() + timeout;
+    auto backoff = microseconds{1};
+    while (word.load(std::memory_order_acquire) == old) {
+        const auto now = steady_clock::now();
+        if (now >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(
+            std::min<steady_clock::duration>(backoff, deadline - now));
+        backoff = std::min(backoff * 2, microseconds{1000});
+    }
+    return true;
+}
+
+inline void atomic_notify_all(std::atomic<std::uint32_t>& word) noexcept {
+    word.notify_all();
+}
+
+#endif
+
+} // namespace better::detail
@@ -0,0 +1,255 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "column_view.hpp"
+#include "io.hpp"
+#include "option.hpp"
+#include "ref.hpp"
+#include "result.hpp"
+#include "void.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace better {
+
+// On-disk layout:
+// [ColumnHeader][values: count * sizeof(T)][padding to 64][validity bitmap]
+struct ColumnHeader {
+    static constexpr char Magic[8] = {'B', 'O', 'P', 'T', 'C', 'O', 'L', '\0'};
+    static constexpr std::uint32_t CurrentVersion = 1;
+    static constexpr std::size_t Alignment = 64;
+
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t value_size;
+    std::uint64_t count;
+    std::uint64_t values_offset;
+    std::uint64_t validity_offset;
+    std::byte reserved[24];
+};
+
+static_assert(sizeof(ColumnHeader) == ColumnHeader::Alignment);
+
+// Streaming writer: values go to the file in chunks as they come,
+// presence bitmap is kept in memory (1 bit per element) until finish()
+template <class T>
+struct ColumnWriter {
+    static_assert(std::is_trivially_copyable_v<T>);
+    static_assert(alignof(T) <= ColumnHeader::Alignment);
+
+    static Result<ColumnWriter, io::IoError> create(const char* path) {
+        auto opened =
+            sys::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (opened.is_err()) {
+            return {Err, io::IoError::os(opened.unwrap_err())};
+        }
+        return {Ok, ColumnWriter{static_cast<int>(opened.unwrap())}};
+    }
+
+    ColumnWriter(ColumnWriter&& other) noexcept
+        : _fd{std::exchange(other._fd, -1)},
+          _count{other._count},
+          _chunk{std::move(other._chunk)},
+          _validity{std::move(other._validity)} {}
+
+    ColumnWriter(const ColumnWriter&) = delete;
+    ColumnWriter& operator=(const ColumnWriter&) = delete;
+    ColumnWriter& operator=(ColumnWriter&&) = delete;
+
+    ~ColumnWriter() {
+        if (_fd >= 0) {
+            (void)sys::close(_fd);
+        }
+    }
+
+    Result<Void, io::IoError> push(const Option<T>& value) {
+        if (value.is_some()) {
+            return push_some(value.unwrap());
+        }
+        return push_none();
+    }
+
+    Result<Void, io::IoError> push_some(const T& value) {
+        set_validity(_count, true);
+        const auto bytes = reinterpret_cast<const std::byte*>(&value);
+        _chunk.insert(_chunk.end(), bytes, bytes + sizeof(T));
+        return pushed();
+    }
+
+    // Missing values are stored as zero bytes, so T need not be
+    // default constructible
+    Result<Void, io::IoError> push_none() {
+        set_validity(_count, false);
+        _chunk.resize(_chunk.size() + sizeof(T));
+        return pushed();
+    }
+
+    // Writes bitmap and header and closes the file
+    Result<Void, io::IoError> finish() && {
+        auto flushed = flush();
+        if (flushed.is_err()) {
+            return flushed;
+        }
+
+        const std::uint64_t values_end =
+            sizeof(ColumnHeader) + _count * sizeof(T);
+        ColumnHeader header{};
+        std::memcpy(header.magic, ColumnHeader::Magic, sizeof(header.magic));
+        header.version = ColumnHeader::CurrentVersion;
+        header.value_size = sizeof(T);
+        header.count = _count;
+        header.values_offset = sizeof(ColumnHeader);
+        header.validity_offset = align_up(values_end);
+
+        auto bitmap = io::write_all_at(
+            _fd, static_cast<off_t>(header.validity_offset),
+            std::as_bytes(std::span{_validity}));
+        if (bitmap.is_err()) {
+            return bitmap;
+        }
+        auto head = io::write_all_at(_fd, 0,
+                                     std::as_bytes(std::span{&header, 1}));
+        if (head.is_err()) {
+            return head;
+        }
+        auto closed = sys::close(std::exchange(_fd, -1));
+        if (closed.is_err()) {
+            return {Err, io::IoError::os(closed.unwrap_err())};
+        }
+        return {Ok};
+    }
+
+  private:
+    static constexpr std::size_t ChunkSize = 64 * 1024;
+
+    explicit ColumnWriter(int fd) : _fd{fd} { _chunk.reserve(ChunkSize); }
+
+    static std::uint64_t align_up(std::uint64_t offset) noexcept {
+        constexpr std::uint64_t A = ColumnHeader::Alignment;
+        return (offset + A - 1) / A * A;
+    }
+
+    void set_validity(std::size_t i, bool is_some) {
+        if (i % 8 == 0) {
+            _validity.push_back(0);
+        }
+        if (is_some) {
+            _validity.back() |= static_cast<std::uint8_t>(1u << (i % 8));
+        }
+    }
+
+    Result<Void, io::IoError> pushed() {
+        ++_count;
+        if (_chunk.size() >= ChunkSize) {
+            return flush();
+        }
+        return {Ok};
+    }
+
+    Result<Void, io::IoError> flush() {
+        const std::uint64_t offset =
+            sizeof(ColumnHeader) + (_count * sizeof(T) - _chunk.size());
+        auto written = io::write_all_at(_fd, static_cast<off_t>(offset),
+                                        std::span{_chunk});
+        _chunk.clear();
+        return written;
+    }
+
+    int _fd;
+    std::uint64_t _count = 0;
+    std::vector<std::byte> _chunk;
+    std::vector<std::uint8_t> _validity;
+};
+
+// Maps column file and exposes it without any deserialization
+template <class T>
+struct ColumnReader {
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    static Result<ColumnReader, io::IoError> open(const char* path) {
+        auto mapped = io::map_file(path);
+        if (mapped.is_err()) {
+            return {Err, mapped.unwrap_err()};
+        }
+        auto file = std::move(mapped).unwrap();
+        auto view = validate(file);
+        if (view.is_err()) {
+            return {Err, view.unwrap_err()};
+        }
+        return {Ok, ColumnReader{std::move(file), view.unwrap()}};
+    }
+
+    std::size_t size() const noexcept { return _view.size(); }
+
+    Option<Ref<const T>> get(std::size_t i) const noexcept {
+        return _view.get(i);
+    }
+
+    // Valid while reader is alive
+    const ColumnView<T>& view() const noexcept { return _view; }
+
+  private:
+    ColumnReader(io::MappedFile file, ColumnView<T> view) noexcept
+        : _file{std::move(file)}, _view{view} {}
+
+    static Result<ColumnView<T>, io::IoError>
+    validate(const io::MappedFile& file) {
+        auto head = file.read_at(0, sizeof(ColumnHeader));
+        if (head.is_err()) {
+            return {Err, io::IoError::invalid_data()};
+        }
+        ColumnHeader header;
+        std::memcpy(&header, head.unwrap().data(), sizeof(header));
+        if (std::memcmp(header.magic, ColumnHeader::Magic,
+                        sizeof(header.magic)) != 0 ||
+            header.version != ColumnHeader::CurrentVersion ||
+            header.value_size != sizeof(T) ||
+            header.values_offset % alignof(T) != 0 ||
+            header.count > file.size() / sizeof(T)) {
+            return {Err, io::IoError::invalid_data()};
+        }
+
+        auto values =
+            file.read_at(header.values_offset, header.count * sizeof(T));
+        auto validity =
+            file.read_at(header.validity_offset, (header.count + 7) / 8);
+        if (values.is_err() || validity.is_err()) {
+            return {Err, io::IoError::invalid_data()};
+        }
+        return {Ok, reinterpret_cast<const T*>(values.unwrap().data()),
+                reinterpret_cast<const std::uint8_t*>(
+                    validity.unwrap().data()),
+                header.count};
+    }
+
+    io::MappedFile _file;
+    ColumnView<T> _view;
+};
+
+} // namespace better
@@ -0,0 +1,70 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "option.hpp"
+#include "ref.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+namespace better {
+
+// Non-owning column of Option<T>: packed values + presence bitmap.
+// Bit i of the bitmap (LSB first) is set if element i is Some.
+// Values of None elements are unspecified
+template <class T>
+struct ColumnView {
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    ColumnView(const T* values, const std::uint8_t* validity,
+               std::size_t size) noexcept
+        : _values{values}, _validity{validity}, _size{size} {}
+
+    std::size_t size() const noexcept { return _size; }
+
+    bool is_some(std::size_t i) const noexcept {
+        return (_validity[i / 8] >> (i % 8)) & 1;
+    }
+
+    // None for missing values and for out of range indices
+    Option<Ref<const T>> get(std::size_t i) const noexcept {
+        if (i < _size && is_some(i)) {
+            return {Some, Ref{_values[i]}};
+        }
+        return None;
+    }
+
+    std::span<const T> values() const noexcept { return {_values, _size}; }
+    std::span<const std::uint8_t> validity() const noexcept {
+        return {_validity, (_size + 7) / 8};
+    }
+
+  private:
+    const T* _values;
+    const std::uint8_t* _validity;
+    std::size_t _size;
+};
+
+} // namespace better
@@ -0,0 +1,199 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "option.hpp"
+#include "ref.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace better {
+
+template <class T, class A>
+struct CompactRef;
+
+// Typed arena that CompactRefs point into. Objects never move, so
+// plain references into the arena stay valid too.
+// Storage for `capacity` objects is allocated up front but not touched:
+// pages get committed as objects are created.
+// Only one Arena<T, Tag> may be alive at a time: CompactRef finds it
+// through the type, which is what lets it be 4 bytes. Creating a second
+// one throws std::logic_error, even when two threads race to do it.
+// Use distinct tags for independent arenas of the same T.
+// emplace() is not thread-safe: one arena has one writer at a time
+template <class T, class Tag = void>
+struct Arena {
+    static_assert(!std::is_const_v<T> && !std::is_reference_v<T>);
+
+    // Index 0 and the last index are reserved for Option niches
+    static constexpr std::uint32_t MaxCapacity = UINT32_MAX - 1;
+
+    explicit Arena(std::uint32_t capacity) {
+        if (capacity > MaxCapacity) {
+            throw std::invalid_argument("arena capacity exceeds 32-bit index");
+        }
+        if (_alive.exchange(true, std::memory_order_acq_rel)) {
+            throw std::logic_error("arena of this type is already alive");
+        }
+        try {
+            _data = static_cast<T*>(
+                ::operator new(std::size_t{capacity} * sizeof(T),
+                               std::align_val_t{alignof(T)}));
+        } catch (...) {
+            _alive.store(false, std::memory_order_release);
+            throw;
+        }
+        _capacity = capacity;
+        _owner = true;
+    }
+
+    Arena(Arena&& other) noexcept : _owner{std::exchange(other._owner, false)} {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    Arena& operator=(Arena&&) = delete;
+
+    ~Arena() {
+        if (!_owner) {
+            return;
+        }
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            std::destroy_n(_data, _size);
+        }
+        ::operator delete(_data, std::align_val_t{alignof(T)});
+        _data = nullptr;
+        _size = 0;
+        _capacity = 0;
+        _alive.store(false, std::memory_order_release);
+    }
+
+    // None if the arena is full
+    template <class... Args>
+    Option<CompactRef<T, Arena>> emplace(Args&&... args) {
+        if (_size == _capacity) {
+            return None;
+        }
+        std::construct_at(_data + _size, std::forward<Args>(args)...);
+        ++_size;
+        return {Some, CompactRef<T, Arena>{_size}};
+    }
+
+    std::uint32_t size() const noexcept { return _size; }
+    std::uint32_t capacity() const noexcept { return _capacity; }
+
+    // Objects of the live arena; null if there is none
+    static T* data() noexcept { return _data; }
+
+  private:
+    // claimed by the constructor before the other statics are touched
+    static inline std::atomic<bool> _alive = false;
+    static inline T* _data = nullptr;
+    static inline std::uint32_t _size = 0;
+    static inline std::uint32_t _capacity = 0;
+
+    bool _owner = false;
+};
+
+// Reference into an Arena as a 32-bit index: half of Ref<T> on 64-bit
+// targets, same interface and const propagation. Valid while the arena
+// is alive
+template <class T, class A>
+struct CompactRef final {
+    using Const = CompactRef<std::add_const_t<T>, A>;
+
+    T& get() noexcept { return A::data()[_index - 1]; }
+    // Propagate const for safety!
+    std::add_const_t<T>& get() const noexcept {
+        return A::data()[_index - 1];
+    }
+
+    decltype(auto) operator*() noexcept { return get(); }
+    decltype(auto) operator*() const noexcept { return get(); }
+
+    T* operator->() noexcept { return &get(); }
+    std::add_const_t<T>* operator->() const noexcept { return &get(); }
+
+    operator T&() noexcept { return get(); }
+    operator std::add_const_t<T>&() const noexcept { return get(); }
+
+    operator Const() const noexcept { return Const{_index}; }
+
+    operator std::remove_const_t<T>() const = delete;
+    operator std::remove_const_t<T>() = delete;
+
+    // Full-size reference to the same object
+    Ref<T> ref() noexcept { return Ref<T>{get()}; }
+    Ref<std::add_const_t<T>> ref() const noexcept {
+        return Ref<std::add_const_t<T>>{get()};
+    }
+
+    bool ref_equals(const CompactRef& other) const noexcept {
+        return _index == other._index;
+    }
+
+    // Position in the arena, starting from 1
+    std::uint32_t index() const noexcept { return _index; }
+
+  private:
+    friend A;
+    friend struct CompactRef<std::remove_const_t<T>, A>;
+    friend struct OptionStorage<CompactRef>;
+
+    explicit CompactRef(std::uint32_t index) noexcept : _index{index} {}
+
+    std::uint32_t _index;
+};
+
+// Index 0 is None, the last index is the niche of Option<Option<>>
+template <class T, class A>
+struct OptionStorage<CompactRef<T, A>> {
+    bool is_some() const noexcept {
+        return _ref._index != 0 && _ref._index != NicheIndex;
+    }
+
+    CompactRef<T, A>& unwrap_unsafe() & noexcept { return _ref; }
+    const CompactRef<T, A>& unwrap_unsafe() const& noexcept { return _ref; }
+    CompactRef<T, A>&& unwrap_unsafe() && noexcept { return std::move(_ref); }
+
+    void swap(OptionStorage& other) noexcept { std::swap(_ref, other._ref); }
+
+    OptionStorage(NoneTag) noexcept : _ref{0} {}
+
+    explicit OptionStorage(NicheTag) noexcept : _ref{NicheIndex} {}
+    bool is_niche() const noexcept { return _ref._index == NicheIndex; }
+
+    OptionStorage(SomeTag, CompactRef<T, A> ref) noexcept : _ref{ref} {}
+
+  private:
+    static constexpr std::uint32_t NicheIndex = UINT32_MAX;
+
+    CompactRef<T, A> _ref;
+};
+
+} // namespace better
@@ -0,0 +1,249 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "atomic_wait.hpp"
+#include "inline_function.hpp"
+#include "option.hpp"
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace better {
+
+using Job = InlineFunction<void()>;
+
+template <class E>
+concept Executor = requires(E& executor, Job job) {
+    executor.execute(std::move(job));
+};
+
+// Non-owning type-erased reference to an executor.
+// Null reference runs jobs inline
+struct ExecutorRef {
+    ExecutorRef() noexcept = default;
+
+    template <Executor E>
+        requires(!std::is_same_v<E, ExecutorRef>)
+    ExecutorRef(E& executor) noexcept
+        : _self{&executor}, _execute{[](void* self, Job&& job) {
+              static_cast<E*>(self)->execute(std::move(job));
+          }} {}
+
+    void execute(Job job) {
+        if (_self == nullptr) {
+            job();
+        } else {
+            _execute(_self, std::move(job));
+        }
+    }
+
+  private:
+    void* _self = nullptr;
+    void (*_execute)(void*, Job&&) = nullptr;
+};
+
+// Runs jobs right away on the calling thread
+struct InlineExecutor {
+    void execute(Job job) { job(); }
+};
+
+// Queues jobs until the owner runs them: deterministic order for tests
+struct ManualExecutor {
+    void execute(Job job) {
+        std::lock_guard lock{_mutex};
+        _jobs.push_back(std::move(job));
+    }
+
+    // Runs the oldest queued job. False if there was none
+    bool run_one() {
+        Job job;
+        {
+            std::lock_guard lock{_mutex};
+            if (_jobs.empty()) {
+                return false;
+            }
+            job = std::move(_jobs.front());
+            _jobs.pop_front();
+        }
+        job();
+        return true;
+    }
+
+    // Runs jobs until the queue is empty, including jobs they schedule.
+    // Returns number of jobs run
+    std::size_t run_all() {
+        std::size_t count = 0;
+        while (run_one()) {
+            ++count;
+        }
+        return count;
+    }
+
+    std::size_t pending() const {
+        std::lock_guard lock{_mutex};
+        return _jobs.size();
+    }
+
+  private:
+    mutable std::mutex _mutex;
+    std::deque<Job> _jobs;
+};
+
+struct ThreadPool;
+
+namespace detail {
+
+// Pool and queue of the current worker thread
+struct PoolWorker {
+    ThreadPool* pool = nullptr;
+    std::size_t index = 0;
+};
+
+} // namespace detail
+
+// Fixed set of worker threads, one job queue per worker.
+// Workers take their own newest jobs first and steal the oldest jobs
+// of others when idle. Jobs scheduled from a worker go to its own queue
+struct ThreadPool {
+    explicit ThreadPool(std::size_t threads) {
+        if (threads == 0) {
+            throw std::invalid_argument("thread pool needs a thread");
+        }
+        for (std::size_t i = 0; i < threads; ++i) {
+            _queues.push_back(std::make_unique<Queue>());
+        }
+        for (std::size_t i = 0; i < threads; ++i) {
+            _threads.emplace_back([this, i] { work(i); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Finishes all queued jobs before joining workers
+    ~ThreadPool() {
+        _stop.store(true);
+        wake();
+        for (auto& thread : _threads) {
+            thread.join();
+        }
+    }
+
+    std::size_t size() const noexcept { return _threads.size(); }
+
+    void execute(Job job) {
+        std::size_t index;
+        if (_current.pool == this) {
+            index = _current.index;
+        } else {
+            index = _next.fetch_add(1, std::memory_order_relaxed) %
+                    _queues.size();
+        }
+        {
+            Queue& queue = *_queues[index];
+            std::lock_guard lock{queue.mutex};
+            queue.jobs.push_back(std::move(job));
+        }
+        wake();
+    }
+
+  private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    static inline thread_local detail::PoolWorker _current;
+
+    void wake() {
+        _epoch.fetch_add(1);
+        if (_sleeping.load() != 0) {
+            detail::atomic_notify_all(_epoch);
+        }
+    }
+
+    Option<Job> pop_own(std::size_t index) {
+        Queue& queue = *_queues[index];
+        std::lock_guard lock{queue.mutex};
+        if (queue.jobs.empty()) {
+            return None;
+        }
+        Option<Job> job{Some, std::move(queue.jobs.back())};
+        queue.jobs.pop_back();
+        return job;
+    }
+
+    Option<Job> steal(std::size_t thief) {
+        for (std::size_t i = 1; i < _queues.size(); ++i) {
+            Queue& queue = *_queues[(thief + i) % _queues.size()];
+            std::lock_guard lock{queue.mutex};
+            if (!queue.jobs.empty()) {
+                Option<Job> job{Some, std::move(queue.jobs.front())};
+                queue.jobs.pop_front();
+                return job;
+            }
+        }
+        return None;
+    }
+
+    void work(std::size_t index) {
+        _current = detail::PoolWorker{this, index};
+        for (;;) {
+            // read before looking for jobs: any job pushed after
+            // the search changes the epoch and cancels the sleep
+            const std::uint32_t epoch = _epoch.load();
+            auto job = pop_own(index);
+            if (job.is_none()) {
+                job = steal(index);
+            }
+            if (job.is_some()) {
+                job.unwrap()();
+                continue;
+            }
+            if (_stop.load()) {
+                return;
+            }
+            _sleeping.fetch_add(1);
+            detail::atomic_wait(_epoch, epoch);
+            _sleeping.fetch_sub(1);
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> _queues;
+    std::vector<std::thread> _threads;
+    std::atomic<std::size_t> _next = 0;
+    std::atomic<std::uint32_t> _epoch = 0;
+    std::atomic<std::uint32_t> _sleeping = 0;
+    std::atomic<bool> _stop = false;
+};
+
+} // namespace better
@@ -0,0 +1,480 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "option.hpp"
+#include "ref.hpp"
+#include "relocate.hpp"
+#include "result.hpp"
+
+#include "storage/raw.hpp"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace better {
+
+namespace detail {
+
+// Control byte of a FlatMap slot:
+// Full slots keep 7 low bits of the hash, free ones have the high bit set
+enum class Ctrl : std::int8_t {
+    Empty = -128,
+    Deleted = -2,
+};
+
+// 16 control bytes matched at once.
+// Bit i of a mask corresponds to control byte i
+struct CtrlGroup {
+    static constexpr std::size_t Width = 16;
+
+#ifdef __SSE2__
+    explicit CtrlGroup(const std::int8_t* ctrl) noexcept
+        : _ctrl{_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))} {}
+
+    std::uint32_t match(std::int8_t h2) const noexcept {
+        return static_cast<std::uint32_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(_ctrl, _mm_set1_epi8(h2))));
+    }
+
+    std::uint32_t match_free() const noexcept {
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(_ctrl));
+    }
+
+  private:
+    __m128i _ctrl;
+#else
+    explicit CtrlGroup(const std::int8_t* ctrl) noexcept {
+        std::memcpy(_ctrl, ctrl, Width);
+    }
+
+    std::uint32_t match(std::int8_t h2) const noexcept {
+        std::uint32_t mask = 0;
+        for (std::size_t i = 0; i < Width; ++i) {
+            mask |= std::uint32_t{_ctrl[i] == h2} << i;
+        }
+        return mask;
+    }
+
+    std::uint32_t match_free() const noexcept {
+        std::uint32_t mask = 0;
+        for (std::size_t i = 0; i < Width; ++i) {
+            mask |= std::uint32_t{_ctrl[i] < 0} << i;
+        }
+        return mask;
+    }
+
+  private:
+    std::int8_t _ctrl[Width];
+#endif
+
+  public:
+    std::uint32_t match_empty() const noexcept {
+        return match(static_cast<std::int8_t>(Ctrl::Empty));
+    }
+};
+
+// std::hash is identity for integers; spread bits before splitting
+// the hash into group index and control byte
+inline std::uint64_t mix_hash(std::uint64_t h) noexcept {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+} // namespace detail
+
+// Open addressing hash map with SIMD probing of control bytes
+// (swiss table). Lookups return Option<Ref<V>> instead of iterators.
+// References are invalidated by insertions that grow the table
+template <class K, class V, class Hash = std::hash<K>,
+          class Eq = std::equal_to<K>>
+struct FlatMap {
+    FlatMap() = default;
+
+    FlatMap(const FlatMap& other) : _hash{other._hash}, _eq{other._eq} {
+        reserve(other._size);
+        other.for_each([this](const K& key, const V& value) {
+            insert(key, value);
+        });
+    }
+
+    FlatMap(FlatMap&& other) noexcept
+        : _ctrl{std::move(other._ctrl)},
+          _slots{std::move(other._slots)},
+          _capacity{std::exchange(other._capacity, 0)},
+          _size{std::exchange(other._size, 0)},
+          _growth_left{std::exchange(other._growth_left, 0)},
+          _hash{std::move(other._hash)},
+          _eq{std::move(other._eq)} {}
+
+    FlatMap& operator=(const FlatMap& other) {
+        FlatMap tmp{other};
+        swap(tmp);
+        return *this;
+    }
+
+    FlatMap& operator=(FlatMap&& other) noexcept {
+        FlatMap tmp{std::move(other)};
+        swap(tmp);
+        return *this;
+    }
+
+    ~FlatMap() { destroy_all(); }
+
+    void swap(FlatMap& other) noexcept {
+        std::swap(_ctrl, other._ctrl);
+        std::swap(_slots, other._slots);
+        std::swap(_capacity, other._capacity);
+        std::swap(_size, other._size);
+        std::swap(_growth_left, other._growth_left);
+        std::swap(_hash, other._hash);
+        std::swap(_eq, other._eq);
+    }
+
+    std::size_t size() const noexcept { return _size; }
+    bool empty() const noexcept { return _size == 0; }
+    std::size_t capacity() const noexcept { return _capacity; }
+
+    Option<Ref<V>> find(const K& key) noexcept(nothrow_lookup) {
+        const auto index = find_index(key);
+        if (index.is_some()) {
+            return {Some, Ref{slot(index.unwrap()).value}};
+        }
+        return None;
+    }
+
+    Option<Ref<const V>> find(const K& key) const
+        noexcept(nothrow_lookup) {
+        const auto index = find_index(key);
+        if (index.is_some()) {
+            return {Some, Ref{slot(index.unwrap()).value}};
+        }
+        return None;
+    }
+
+    bool contains(const K& key) const noexcept(nothrow_lookup) {
+        return find_index(key).is_some();
+    }
+
+    // Ok with the new value if `key` was absent.
+    // Err with the existing value otherwise: it is left untouched
+    // and `args` are not used
+    template <class... Args>
+    Result<Ref<V>, Ref<V>> insert(K key, Args&&... args)
+        requires std::is_constructible_v<V, Args...>
+    {
+        const std::uint64_t hash = hash_of(key);
+        const auto existing = find_index(key, hash);
+        if (existing.is_some()) {
+            return {Err, Ref{slot(existing.unwrap()).value}};
+        }
+        if (_growth_left == 0) {
+            // `args` may refer into this map: build the value before
+            // grow() moves the elements
+            V value(std::forward<Args>(args)...);
+            grow();
+            return place(std::move(key), hash, std::move(value));
+        }
+        return place(std::move(key), hash, std::forward<Args>(args)...);
+    }
+
+    // Moves the value out of the map
+    Option<V> remove(const K& key) {
+        const auto index = find_index(key);
+        if (index.is_none()) {
+            return None;
+        }
+        const std::size_t i = index.unwrap();
+        Slot& removed = slot(i);
+        Option<V> value{Some, std::move(removed.value)};
+        std::destroy_at(&removed);
+
+        // Probes stop at the first group with an empty slot.
+        // If this group has one, nobody probes past it and the slot
+        // can be empty again; otherwise it must stay a tombstone
+        const std::size_t group = i - i % detail::CtrlGroup::Width;
+        if (detail::CtrlGroup{&_ctrl[group]}.match_empty() != 0) {
+            _ctrl[i] = empty_ctrl;
+            ++_growth_left;
+        } else {
+            _ctrl[i] = static_cast<std::int8_t>(detail::Ctrl::Deleted);
+        }
+        --_size;
+        return value;
+    }
+
+    void clear() noexcept {
+        destroy_all();
+        if (_capacity != 0) {
+            std::memset(_ctrl.get(), empty_ctrl, _capacity);
+        }
+        _size = 0;
+        _growth_left = max_load(_capacity);
+    }
+
+    // Makes room for `n` elements without further rehashing
+    void reserve(std::size_t n) {
+        if (n > max_load(_capacity)) {
+            rehash(capacity_for(n));
+        }
+    }
+
+    // f(const K&, V&) for every element, in no particular order
+    template <class F>
+    void for_each(F&& f) {
+        for (std::size_t i = 0; i < _capacity; ++i) {
+            if (_ctrl[i] >= 0) {
+                f(std::as_const(slot(i).key), slot(i).value);
+            }
+        }
+    }
+
+    template <class F>
+    void for_each(F&& f) const {
+        for (std::size_t i = 0; i < _capacity; ++i) {
+            if (_ctrl[i] >= 0) {
+                f(slot(i).key, slot(i).value);
+            }
+        }
+    }
+
+  private:
+    struct Slot {
+        K key;
+        V value;
+    };
+
+    static constexpr std::int8_t empty_ctrl =
+        static_cast<std::int8_t>(detail::Ctrl::Empty);
+
+    static constexpr bool nothrow_relocate =
+        (is_trivially_relocatable_v<K> ||
+         std::is_nothrow_move_constructible_v<K>) &&
+        (is_trivially_relocatable_v<V> ||
+         std::is_nothrow_move_constructible_v<V>);
+
+    // Lookups run user Hash and Eq, which may throw
+    static constexpr bool nothrow_lookup =
+        std::is_nothrow_invocable_v<const Hash&, const K&> &&
+        std::is_nothrow_invocable_v<const Eq&, const K&, const K&>;
+
+    static std::size_t max_load(std::size_t capacity) noexcept {
+        return capacity - capacity / 8;
+    }
+
+    static std::size_t capacity_for(std::size_t n) noexcept {
+        std::size_t capacity = detail::CtrlGroup::Width;
+        while (max_load(capacity) < n) {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    std::uint64_t hash_of(const K& key) const {
+        return detail::mix_hash(static_cast<std::uint64_t>(_hash(key)));
+    }
+
+    static std::int8_t h2(std::uint64_t hash) noexcept {
+        return static_cast<std::int8_t>(hash & 0x7F);
+    }
+
+    Slot* slot_ptr(std::size_t i) noexcept {
+        return reinterpret_cast<Slot*>(_slots[i].get_bytes());
+    }
+    Slot& slot(std::size_t i) noexcept { return *_slots[i].get_raw(); }
+    const Slot& slot(std::size_t i) const noexcept {
+        return *_slots[i].get_raw();
+    }
+
+    Option<std::size_t> find_index(const K& key) const {
+        return find_index(key, hash_of(key));
+    }
+
+    // Probing visits groups in triangular order, which hits every group
+    // when the number of groups is a power of two
+    Option<std::size_t> find_index(const K& key, std::uint64_t hash) const {
+        if (_capacity == 0) {
+            return None;
+        }
+        const std::size_t groups = _capacity / detail::CtrlGroup::Width;
+        std::size_t group = (hash >> 7) & (groups - 1);
+        for (std::size_t step = 1; step <= groups; ++step) {
+            const std::size_t first = group * detail::CtrlGroup::Width;
+            const detail::CtrlGroup ctrl{&_ctrl[first]};
+            for (auto bits = ctrl.match(h2(hash)); bits != 0;
+                 bits &= bits - 1) {
+                const std::size_t i = first + std::countr_zero(bits);
+                if (_eq(slot(i).key, key)) {
+                    return {Some, i};
+                }
+            }
+            if (ctrl.match_empty() != 0) {
+                return None;
+            }
+            group = (group + step) & (groups - 1);
+        }
+        return None;
+    }
+
+    // First empty or deleted slot on the probe sequence.
+    // Table is never full, so there is always one
+    std::size_t find_free(std::uint64_t hash) const noexcept {
+        return find_free(_ctrl.get(), _capacity, hash);
+    }
+
+    static std::size_t find_free(const std::int8_t* ctrl_bytes,
+                                 std::size_t capacity,
+                                 std::uint64_t hash) noexcept {
+        const std::size_t groups = capacity / detail::CtrlGroup::Width;
+        std::size_t group = (hash >> 7) & (groups - 1);
+        for (std::size_t step = 1;; ++step) {
+            const std::size_t first = group * detail::CtrlGroup::Width;
+            const auto bits =
+                detail::CtrlGroup{&ctrl_bytes[first]}.match_free();
+            if (bits != 0) {
+                return first + std::countr_zero(bits);
+            }
+            group = (group + step) & (groups - 1);
+        }
+    }
+
+    // Called when there is no room left: drops tombstones,
+    // doubling capacity only if the table is really full
+    void grow() {
+        if (_capacity == 0) {
+            rehash(detail::CtrlGroup::Width);
+        } else if (_size < max_load(_capacity) / 2) {
+            rehash(_capacity);
+        } else {
+            rehash(_capacity * 2);
+        }
+    }
+
+    template <class... Args>
+    Result<Ref<V>, Ref<V>> place(K&& key, std::uint64_t hash,
+                                 Args&&... args) {
+        const std::size_t index = find_free(hash);
+        Slot* const target = slot_ptr(index);
+        std::construct_at(&target->key, std::move(key));
+        try {
+            std::construct_at(&target->value, std::forward<Args>(args)...);
+        } catch (...) {
+            std::destroy_at(&target->key);
+            throw;
+        }
+        _growth_left -= _ctrl[index] == empty_ctrl;
+        _ctrl[index] = h2(hash);
+        ++_size;
+        return {Ok, Ref{target->value}};
+    }
+
+    // Strong guarantee: the table is replaced only once every element
+    // has its place and its copy in the new one
+    void rehash(std::size_t capacity) {
+        auto ctrl = std::make_unique_for_overwrite<std::int8_t[]>(capacity);
+        std::memset(ctrl.get(), empty_ctrl, capacity);
+        auto slots =
+            std::make_unique_for_overwrite<RawStorage<Slot>[]>(capacity);
+
+        // Hash may throw: all placements are found before anything moves
+        auto dest = std::make_unique_for_overwrite<std::size_t[]>(_capacity);
+        for (std::size_t i = 0; i < _capacity; ++i) {
+            if (_ctrl[i] < 0) {
+                continue;
+            }
+            const std::uint64_t hash = hash_of(slot(i).key);
+            dest[i] = find_free(ctrl.get(), capacity, hash);
+            ctrl[dest[i]] = h2(hash);
+        }
+
+        auto new_slot = [&](std::size_t i) {
+            return reinterpret_cast<Slot*>(slots[dest[i]].get_bytes());
+        };
+        if constexpr (nothrow_relocate) {
+            for (std::size_t i = 0; i < _capacity; ++i) {
+                if (_ctrl[i] >= 0) {
+                    relocate_at(&slot_ptr(i)->key, &new_slot(i)->key);
+                    relocate_at(&slot_ptr(i)->value, &new_slot(i)->value);
+                }
+            }
+        } else {
+            // like std::vector: copy unless moves cannot throw, and keep
+            // the old elements until all of them are in place
+            std::size_t i = 0;
+            try {
+                for (; i < _capacity; ++i) {
+                    if (_ctrl[i] >= 0) {
+                        std::construct_at(new_slot(i),
+                                          std::move_if_noexcept(slot(i)));
+                    }
+                }
+            } catch (...) {
+                for (std::size_t j = 0; j < i; ++j) {
+                    if (_ctrl[j] >= 0) {
+                        std::destroy_at(new_slot(j));
+                    }
+                }
+                throw;
+            }
+            destroy_all();
+        }
+
+        _ctrl = std::move(ctrl);
+        _slots = std::move(slots);
+        _capacity = capacity;
+        _growth_left = max_load(_capacity) - _size;
+    }
+
+    void destroy_all() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<Slot>) {
+            for (std::size_t i = 0; i < _capacity; ++i) {
+                if (_ctrl[i] >= 0) {
+                    std::destroy_at(&slot(i));
+                }
+            }
+        }
+    }
+
+    std::unique_ptr<std::int8_t[]> _ctrl;
+    std::unique_ptr<RawStorage<Slot>[]> _slots;
+    std::size_t _capacity = 0;
+    std::size_t _size = 0;
+    std::size_t _growth_left = 0;
+    [[no_unique_address]] Hash _hash;
+    [[no_unique_address]] Eq _eq;
+};
+
+} // namespace better
@@ -0,0 +1,276 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "executor.hpp"
+#include "option.hpp"
+#include "result.hpp"
+#include "task.hpp"
+#include "timer.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace better {
+
+// Errors of every callable of a failed first_ok, in argument order
+template <class E, std::size_t N>
+using ErrorList = std::array<E, N>;
+
+namespace detail {
+template <bool FirstOk, class T, class E, class... F>
+struct RaceState;
+} // namespace detail
+
+// Tells a running callable that the race is decided and its result
+// will be dropped. Callables taking it may give up early
+struct CancelToken {
+    bool is_cancelled() const noexcept {
+        return _decided->load(std::memory_order_acquire) != 0;
+    }
+
+  private:
+    template <bool, class, class, class...>
+    friend struct detail::RaceState;
+
+    explicit CancelToken(const std::atomic<std::uint32_t>* decided) noexcept
+        : _decided{decided} {}
+
+    const std::atomic<std::uint32_t>* _decided;
+};
+
+// Launch schedule: callable i starts at the latest `delay * i` after
+// the first one, and right away when an earlier one fails.
+// Nothing new starts once the race is decided
+template <Timer T>
+struct Hedge {
+    T& timer;
+    typename T::time_point::duration delay;
+};
+
+namespace detail {
+
+template <class T>
+constexpr bool IsHedge = false;
+
+template <class T>
+constexpr bool IsHedge<Hedge<T>> = true;
+
+template <class F>
+decltype(auto) call_with_token(F& f, CancelToken token) {
+    if constexpr (std::is_invocable_v<F&, CancelToken>) {
+        return f(token);
+    } else {
+        return f();
+    }
+}
+
+template <class F>
+using RaceResult = std::decay_t<decltype(call_with_token(
+    std::declval<F&>(), std::declval<CancelToken>()))>;
+
+// Shared by all callables of one race. The first one to decide it
+// (first Ok, first result of any kind or the last Err) fulfills the task
+template <bool FirstOk, class T, class E, class... F>
+struct RaceState
+    : std::enable_shared_from_this<RaceState<FirstOk, T, E, F...>> {
+    static constexpr std::size_t N = sizeof...(F);
+    using Error = std::conditional_t<FirstOk, ErrorList<E, N>, E>;
+
+    RaceState(ExecutorRef executor, TaskPromise<T, Error> promise, F&&... fs)
+        : executor{executor},
+          promise{std::move(promise)},
+          fs{std::forward<F>(fs)...},
+          errors{[]<std::size_t... I>(std::index_sequence<I...>) {
+              return std::array<Option<E>, N>{((void)I, Option<E>{None})...};
+          }(std::make_index_sequence<N>{})} {}
+
+    // Hands callable I over to the executor unless it was already
+    // started by its hedge timer or by an earlier failure
+    template <std::size_t I>
+    bool start() {
+        if (started[I].exchange(true, std::memory_order_acq_rel)) {
+            return false;
+        }
+        executor.execute(
+            [self = this->shared_from_this()] { self->template run<I>(); });
+        return true;
+    }
+
+    template <std::size_t I>
+    void run() {
+        if (decided.load(std::memory_order_acquire) != 0) {
+            return;
+        }
+        auto result = call_guarded<I>();
+        if constexpr (!FirstOk) {
+            if (decide()) {
+                std::move(promise).set(std::move(result));
+            }
+        } else if (result.is_ok()) {
+            if (decide()) {
+                std::move(promise).set_ok(std::move(result).unwrap());
+            }
+        } else {
+            errors[I].insert(std::move(result).unwrap_err());
+            if (failed.fetch_add(1, std::memory_order_acq_rel) + 1 == N) {
+                if (decide()) {
+                    std::move(promise).set_err(collect_errors(
+                        std::make_index_sequence<N>{}));
+                }
+            } else {
+                // a failure frees its slot: the next hedge need not wait
+                // for its delay
+                start_next<I + 1>();
+            }
+        }
+    }
+
+    ExecutorRef executor;
+    TaskPromise<T, Error> promise;
+    std::tuple<std::decay_t<F>...> fs;
+    std::array<Option<E>, N> errors;
+    std::array<std::atomic<bool>, N> started{};
+    std::atomic<std::uint32_t> decided = 0;
+    std::atomic<std::size_t> failed = 0;
+
+  private:
+    // A throwing callable must not leave the race undecided forever:
+    // its exception becomes its Err if E can hold std::exception_ptr,
+    // and terminates the program otherwise
+    template <std::size_t I>
+    Result<T, E> call_guarded() {
+        try {
+            return call_with_token(std::get<I>(fs), CancelToken{&decided});
+        } catch (...) {
+            if constexpr (std::is_constructible_v<E, std::exception_ptr>) {
+                return {Err, std::current_exception()};
+            } else {
+                std::terminate();
+            }
+        }
+    }
+
+    template <std::size_t J>
+    void start_next() {
+        if constexpr (J < N) {
+            if (!start<J>()) {
+                start_next<J + 1>();
+            }
+        }
+    }
+
+    bool decide() noexcept {
+        return decided.exchange(1, std::memory_order_acq_rel) == 0;
+    }
+
+    template <std::size_t... I>
+    ErrorList<E, N> collect_errors(std::index_sequence<I...>) {
+        return {std::move(errors[I]).unwrap()...};
+    }
+};
+
+struct NoHedge {};
+
+template <std::size_t I, class Schedule, class State>
+void launch(Schedule& schedule, const std::shared_ptr<State>& state) {
+    if constexpr (IsHedge<Schedule>) {
+        if (I > 0 && schedule.delay > schedule.delay.zero()) {
+            // the delay is only the latest launch time: a failure of an
+            // earlier callable starts this one right away, and then
+            // the timer job is a no-op
+            schedule.timer.call_at(
+                schedule.timer.now() + schedule.delay * I,
+                [state] { state->template start<I>(); });
+            return;
+        }
+    }
+    state->template start<I>();
+}
+
+template <bool FirstOk, class Schedule, class F0, class... F>
+auto start_race(ExecutorRef executor, Schedule schedule, F0&& f0,
+                F&&... fs) {
+    using R = RaceResult<F0>;
+    static_assert(IsResult<R>, "raced functions must return Result");
+    static_assert((std::is_same_v<R, RaceResult<F>> && ...),
+                  "raced functions must return the same Result type");
+
+    return [&]<class T, class E>(Result<T, E>*) {
+        using State = RaceState<FirstOk, T, E, F0, F...>;
+        auto [promise, task] = make_task<T, typename State::Error>();
+        auto state = std::make_shared<State>(executor, std::move(promise),
+                                             std::forward<F0>(f0),
+                                             std::forward<F>(fs)...);
+
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            (launch<I>(schedule, state), ...);
+        }(std::make_index_sequence<State::N>{});
+        return std::move(task);
+    }(static_cast<R*>(nullptr));
+}
+
+} // namespace detail
+
+// Runs all `f() -> Result<T, E>` (or `f(CancelToken)`) on `executor`.
+// The task gets the first Ok, or every Err as ErrorList<E, N> if all
+// of them fail. The rest are cancelled through their CancelToken.
+// Callables should not throw: an exception counts as an Err only if
+// E is constructible from std::exception_ptr, otherwise it terminates
+template <class... F>
+    requires(sizeof...(F) > 0 && (!detail::IsHedge<std::decay_t<F>> && ...))
+auto first_ok(ExecutorRef executor, F&&... fs) {
+    return detail::start_race<true>(executor, detail::NoHedge{},
+                                    std::forward<F>(fs)...);
+}
+
+// Hedged first_ok: callable i is launched `hedge.delay * i` after the
+// start if nothing has succeeded by then, or as soon as an earlier
+// callable fails
+template <Timer T, class... F>
+    requires(sizeof...(F) > 0)
+auto first_ok(ExecutorRef executor, Hedge<T> hedge, F&&... fs) {
+    return detail::start_race<true>(executor, hedge, std::forward<F>(fs)...);
+}
+
+// Like first_ok, but the first result wins whether it is Ok or Err
+template <class... F>
+    requires(sizeof...(F) > 0 && (!detail::IsHedge<std::decay_t<F>> && ...))
+auto race(ExecutorRef executor, F&&... fs) {
+    return detail::start_race<false>(executor, detail::NoHedge{},
+                                     std::forward<F>(fs)...);
+}
+
+template <Timer T, class... F>
+    requires(sizeof...(F) > 0)
+auto race(ExecutorRef executor, Hedge<T> hedge, F&&... fs) {
+    return detail::start_race<false>(executor, hedge, std::forward<F>(fs)...);
+}
+
+} // namespace better
@@ -0,0 +1,135 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace better {
+
+template <class Signature, std::size_t Capacity = 48>
+struct InlineFunction;
+
+// Move-only type-erased callable.
+// Callables up to Capacity bytes live inside the object itself,
+// larger ones (or ones that may throw on move) go to the heap
+template <class R, class... Args, std::size_t Capacity>
+struct InlineFunction<R(Args...), Capacity> {
+    InlineFunction() noexcept = default;
+
+    template <class F>
+        requires(!std::is_same_v<std::decay_t<F>, InlineFunction> &&
+                 std::is_invocable_r_v<R, std::decay_t<F>&, Args...>)
+    InlineFunction(F&& f) {
+        using Fn = std::decay_t<F>;
+        if constexpr (IsInline<Fn>) {
+            new (_buffer) Fn(std::forward<F>(f));
+            _ops = &inline_ops<Fn>;
+        } else {
+            new (_buffer) Fn*(new Fn(std::forward<F>(f)));
+            _ops = &heap_ops<Fn>;
+        }
+    }
+
+    InlineFunction(InlineFunction&& other) noexcept
+        : _ops{std::exchange(other._ops, nullptr)} {
+        if (_ops != nullptr) {
+            _ops->relocate(other._buffer, _buffer);
+        }
+    }
+
+    InlineFunction& operator=(InlineFunction&& other) noexcept {
+        if (this != &other) {
+            reset();
+            _ops = std::exchange(other._ops, nullptr);
+            if (_ops != nullptr) {
+                _ops->relocate(other._buffer, _buffer);
+            }
+        }
+        return *this;
+    }
+
+    InlineFunction(const InlineFunction&) = delete;
+    InlineFunction& operator=(const InlineFunction&) = delete;
+
+    ~InlineFunction() { reset(); }
+
+    explicit operator bool() const noexcept { return _ops != nullptr; }
+
+    R operator()(Args... args) {
+        return _ops->invoke(_buffer, std::forward<Args>(args)...);
+    }
+
+    // True if callables of type F are stored without allocation
+    template <class F>
+    static constexpr bool IsInline =
+        sizeof(F) <= Capacity && alignof(F) <= alignof(std::max_align_t) &&
+        std::is_nothrow_move_constructible_v<F>;
+
+  private:
+    struct Ops {
+        R (*invoke)(void*, Args&&...);
+        // move-construct into `to` and destroy `from`
+        void (*relocate)(void* from, void* to) noexcept;
+        void (*destroy)(void*) noexcept;
+    };
+
+    template <class Fn>
+    static constexpr Ops inline_ops = {
+        [](void* self, Args&&... args) -> R {
+            return std::invoke(*static_cast<Fn*>(self),
+                               std::forward<Args>(args)...);
+        },
+        [](void* from, void* to) noexcept {
+            new (to) Fn(std::move(*static_cast<Fn*>(from)));
+            std::destroy_at(static_cast<Fn*>(from));
+        },
+        [](void* self) noexcept { std::destroy_at(static_cast<Fn*>(self)); },
+    };
+
+    template <class Fn>
+    static constexpr Ops heap_ops = {
+        [](void* self, Args&&... args) -> R {
+            return std::invoke(**static_cast<Fn**>(self),
+                               std::forward<Args>(args)...);
+        },
+        [](void* from, void* to) noexcept {
+            new (to) Fn*(*static_cast<Fn**>(from));
+        },
+        [](void* self) noexcept { delete *static_cast<Fn**>(self); },
+    };
+
+    void reset() noexcept {
+        if (_ops != nullptr) {
+            std::exchange(_ops, nullptr)->destroy(_buffer);
+        }
+    }
+
+    const Ops* _ops = nullptr;
+    alignas(std::max_align_t) std::byte _buffer[Capacity];
+};
+
+} // namespace better
@@ -0,0 +1,302 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "option.hpp"
+#include "result.hpp"
+#include "sys.hpp"
+#include "void.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <utility>
+
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+namespace better {
+
+namespace io {
+
+struct IoError {
+    enum class Kind : std::uint8_t {
+        // Syscall failed, see code()
+        Os,
+        // File ended before the requested range was read
+        UnexpectedEof,
+        // Requested range is outside of the mapped file
+        OutOfRange,
+        // File content doesn't match expected format
+        InvalidData,
+    };
+
+    static IoError os(sys::Errno err) noexcept {
+        return IoError{Kind::Os, err.code()};
+    }
+    static IoError unexpected_eof() noexcept {
+        return IoError{Kind::UnexpectedEof, 0};
+    }
+    static IoError out_of_range() noexcept {
+        return IoError{Kind::OutOfRange, 0};
+    }
+    static IoError invalid_data() noexcept {
+        return IoError{Kind::InvalidData, 0};
+    }
+
+    Kind kind() const noexcept { return _kind; }
+    // errno value for Kind::Os, 0 otherwise
+    int code() const noexcept { return _code; }
+
+    const char* message() const noexcept {
+        switch (_kind) {
+        case Kind::Os:
+            return std::strerror(_code);
+        case Kind::UnexpectedEof:
+            return "unexpected end of file";
+        case Kind::OutOfRange:
+            return "range is out of file bounds";
+        case Kind::InvalidData:
+            return "invalid data";
+        }
+        return "unknown io error";
+    }
+
+  private:
+    friend struct better::option_flag_traits<IoError>;
+
+    IoError(Kind kind, int code) noexcept : _kind{kind}, _code{code} {}
+
+    Kind _kind;
+    int _code;
+};
+
+using Bytes = std::span<const std::byte>;
+
+} // namespace io
+
+// Kind byte has spare values: Result<Bytes, IoError> needs no extra flag
+template <>
+struct option_flag_traits<io::IoError> {
+    static void set_none(std::byte* bytes) noexcept {
+        bytes[offsetof(io::IoError, _kind)] = std::byte{0xFF};
+    }
+    static bool is_none(const std::byte* bytes) noexcept {
+        return bytes[offsetof(io::IoError, _kind)] == std::byte{0xFF};
+    }
+};
+
+namespace io {
+
+static_assert(sizeof(Result<Bytes, IoError>) ==
+              sizeof(Bytes) + sizeof(IoError));
+
+// Read-only private mapping of the whole file.
+// Views returned by it are valid while MappedFile is alive
+struct MappedFile {
+    MappedFile(MappedFile&& other) noexcept
+        : _data{std::exchange(other._data, nullptr)},
+          _size{std::exchange(other._size, 0)} {}
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        MappedFile tmp{std::move(other)};
+        std::swap(_data, tmp._data);
+        std::swap(_size, tmp._size);
+        return *this;
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        if (_data != nullptr) {
+            // nothing to do with an error in destructor
+            (void)sys::munmap(const_cast<std::byte*>(_data), _size);
+        }
+    }
+
+    Bytes bytes() const noexcept { return Bytes{_data, _size}; }
+    std::size_t size() const noexcept { return _size; }
+
+    // Bounds checked view into the mapping
+    Result<Bytes, IoError> read_at(std::size_t offset,
+                                   std::size_t len) const noexcept {
+        if (offset > _size || len > _size - offset) {
+            return {Err, IoError::out_of_range()};
+        }
+        return {Ok, _data + offset, len};
+    }
+
+  private:
+    friend Result<MappedFile, IoError> map_file(const char* path) noexcept;
+
+    MappedFile(const std::byte* data, std::size_t size) noexcept
+        : _data{data}, _size{size} {}
+
+    const std::byte* _data;
+    std::size_t _size;
+};
+
+inline Result<MappedFile, IoError> map_file(const char* path) noexcept {
+    auto opened = sys::open(path, O_RDONLY | O_CLOEXEC);
+    if (opened.is_err()) {
+        return {Err, IoError::os(opened.unwrap_err())};
+    }
+    const int fd = static_cast<int>(opened.unwrap());
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        const auto err = sys::Errno::last();
+        (void)sys::close(fd);
+        return {Err, IoError::os(err)};
+    }
+
+    const auto size = static_cast<std::size_t>(st.st_size);
+    if (size == 0) {
+        // mmap of zero length is an error
+        (void)sys::close(fd);
+        return {Ok, MappedFile{nullptr, 0}};
+    }
+
+    auto mapped = sys::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // mapping keeps file alive on its own
+    (void)sys::close(fd);
+    if (mapped.is_err()) {
+        return {Err, IoError::os(mapped.unwrap_err())};
+    }
+    const auto* data = static_cast<const std::byte*>(mapped.unwrap().get());
+    return {Ok, MappedFile{data, size}};
+}
+
+// Fills the whole `buf` from the current file position.
+// Returns view of `buf`, no copies are made
+inline Result<Bytes, IoError> read_exact(int fd,
+                                         std::span<std::byte> buf) noexcept {
+    std::size_t done = 0;
+    while (done < buf.size()) {
+        auto n = sys::read(fd, buf.data() + done, buf.size() - done);
+        if (n.is_err()) {
+            if (n.unwrap_err().code() == EINTR) {
+                continue;
+            }
+            return {Err, IoError::os(n.unwrap_err())};
+        }
+        if (n.unwrap() == 0) {
+            return {Err, IoError::unexpected_eof()};
+        }
+        done += n.unwrap();
+    }
+    return {Ok, buf.data(), buf.size()};
+}
+
+// Fills the whole `buf` from `offset` without moving file position
+inline Result<Bytes, IoError> read_at(int fd, off_t offset,
+                                      std::span<std::byte> buf) noexcept {
+    std::size_t done = 0;
+    while (done < buf.size()) {
+        auto n = sys::pread(fd, buf.data() + done, buf.size() - done,
+                            offset + static_cast<off_t>(done));
+        if (n.is_err()) {
+            if (n.unwrap_err().code() == EINTR) {
+                continue;
+            }
+            return {Err, IoError::os(n.unwrap_err())};
+        }
+        if (n.unwrap() == 0) {
+            return {Err, IoError::unexpected_eof()};
+        }
+        done += n.unwrap();
+    }
+    return {Ok, buf.data(), buf.size()};
+}
+
+// Writes the whole `data` at `offset`
+inline Result<Void, IoError> write_all_at(int fd, off_t offset,
+                                          Bytes data) noexcept {
+    std::size_t done = 0;
+    while (done < data.size()) {
+        auto n = sys::pwrite(fd, data.data() + done, data.size() - done,
+                             offset + static_cast<off_t>(done));
+        if (n.is_err()) {
+            if (n.unwrap_err().code() == EINTR) {
+                continue;
+            }
+            return {Err, IoError::os(n.unwrap_err())};
+        }
+        done += n.unwrap();
+    }
+    return {Ok};
+}
+
+// Scatter read into caller buffers with as few syscalls as possible.
+// A single Bytes view cannot describe several buffers, so the views are
+// returned in `bufs` itself: each one is trimmed to the bytes read into
+// it, and the result is the prefix of `bufs` that got any data.
+// It is shorter than `bufs` (or its last view is trimmed) only on EOF.
+// No copies are made
+inline Result<std::span<std::span<std::byte>>, IoError>
+readv(int fd, std::span<std::span<std::byte>> bufs) noexcept {
+    constexpr std::size_t Batch = 64;
+    iovec iov[Batch];
+
+    std::size_t first = 0;
+    // bytes already read into bufs[first]
+    std::size_t skip = 0;
+    while (first < bufs.size()) {
+        const std::size_t count = std::min(Batch, bufs.size() - first);
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto& buf = bufs[first + i];
+            const std::size_t offset = i == 0 ? skip : 0;
+            iov[i] = iovec{buf.data() + offset, buf.size() - offset};
+        }
+        const ssize_t ret = ::readv(fd, iov, static_cast<int>(count));
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return {Err, IoError::os(sys::Errno::last())};
+        }
+        if (ret == 0) {
+            break;
+        }
+
+        auto left = static_cast<std::size_t>(ret);
+        while (first < bufs.size() && left >= bufs[first].size() - skip) {
+            left -= bufs[first].size() - skip;
+            skip = 0;
+            ++first;
+        }
+        skip += left;
+    }
+    if (skip != 0) {
+        bufs[first] = bufs[first].first(skip);
+        ++first;
+    }
+    return {Ok, bufs.first(first)};
+}
+
+} // namespace io
+
+} // namespace better
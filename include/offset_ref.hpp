@@ -0,0 +1,171 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "option.hpp"
+#include "ref.hpp"
+
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace better {
+
+// Self-relative reference: stores the distance from its own address to
+// the target. A structure that keeps OffsetRefs only to objects inside
+// one memory region stays valid wherever the region is mapped, so it can
+// be written to a file or shared memory and used after mmap as is.
+// C++ copies re-point the offset: a copy refers to the same object.
+// Offset 0 is reserved for Option's None, so an OffsetRef can't point
+// at its own address (e.g. from the first member to the enclosing object).
+// Offset is std::int64_t by default; std::int32_t halves the size for
+// regions under 2 GiB
+template <class T, std::signed_integral Offset = std::int64_t>
+struct OffsetRef final {
+    static_assert(!std::is_reference_v<T>);
+    static_assert(!std::is_same_v<T, void>);
+
+    using Const = OffsetRef<std::add_const_t<T>, Offset>;
+
+    explicit OffsetRef(T& x) : _offset{distance_to(&x)} {}
+    // Rvalues are banned!
+    OffsetRef(T&&) = delete;
+
+    OffsetRef(const OffsetRef& other) : _offset{distance_to(other.target())} {}
+
+    OffsetRef& operator=(const OffsetRef& other) {
+        _offset = distance_to(other.target());
+        return *this;
+    }
+
+    T& get() noexcept { return *target(); }
+    // Propagate const for safety!
+    std::add_const_t<T>& get() const noexcept { return *target(); }
+
+    decltype(auto) operator*() noexcept { return get(); }
+    decltype(auto) operator*() const noexcept { return get(); }
+
+    T* operator->() noexcept { return target(); }
+    std::add_const_t<T>* operator->() const noexcept { return target(); }
+
+    operator T&() noexcept { return get(); }
+    operator std::add_const_t<T>&() const noexcept { return get(); }
+
+    operator Const() const { return Const{get()}; }
+
+    operator std::remove_const_t<T>() const = delete;
+    operator std::remove_const_t<T>() = delete;
+
+    // Absolute reference, valid only for the current mapping
+    Ref<T> ref() noexcept { return Ref<T>{get()}; }
+    Ref<std::add_const_t<T>> ref() const noexcept {
+        return Ref<std::add_const_t<T>>{get()};
+    }
+
+    bool ref_equals(const OffsetRef& other) const noexcept {
+        return target() == other.target();
+    }
+
+    // Raw distance in bytes from this object to the target
+    Offset offset() const noexcept { return _offset; }
+
+  private:
+    friend struct OptionStorage<OffsetRef>;
+
+    struct RawTag {};
+
+    OffsetRef(RawTag, Offset offset) noexcept : _offset{offset} {}
+
+    T* target() const noexcept {
+        return reinterpret_cast<T*>(reinterpret_cast<std::uintptr_t>(this) +
+                                    static_cast<std::uintptr_t>(_offset));
+    }
+
+    Offset distance_to(const volatile T* target) const {
+        const auto diff = static_cast<std::intptr_t>(
+            reinterpret_cast<std::uintptr_t>(target) -
+            reinterpret_cast<std::uintptr_t>(this));
+        if (diff == 0) {
+            throw std::invalid_argument("OffsetRef can't point at itself");
+        }
+        if (diff < std::numeric_limits<Offset>::min() + 1 ||
+            diff > std::numeric_limits<Offset>::max()) {
+            throw std::out_of_range("OffsetRef target is too far away");
+        }
+        return static_cast<Offset>(diff);
+    }
+
+    Offset _offset;
+};
+
+// Offset 0 is None, the smallest offset is the niche of Option<Option<>>.
+// Copies and swaps go through target addresses, never raw offsets
+template <class T, std::signed_integral Offset>
+struct OptionStorage<OffsetRef<T, Offset>> {
+    using Handle = OffsetRef<T, Offset>;
+
+    bool is_some() const noexcept {
+        return _ref._offset != 0 && _ref._offset != NicheOffset;
+    }
+
+    Handle& unwrap_unsafe() & noexcept { return _ref; }
+    const Handle& unwrap_unsafe() const& noexcept { return _ref; }
+    Handle&& unwrap_unsafe() && noexcept { return std::move(_ref); }
+
+    void swap(OptionStorage& other) {
+        OptionStorage tmp{other};
+        other = *this;
+        *this = tmp;
+    }
+
+    OptionStorage(NoneTag) noexcept : _ref{typename Handle::RawTag{}, 0} {}
+
+    explicit OptionStorage(NicheTag) noexcept
+        : _ref{typename Handle::RawTag{}, NicheOffset} {}
+    bool is_niche() const noexcept { return _ref._offset == NicheOffset; }
+
+    OptionStorage(SomeTag, const Handle& ref) : _ref{ref} {}
+
+    OptionStorage(const OptionStorage& other)
+        : _ref{other.is_some() ? Handle{other._ref}
+                               : Handle{typename Handle::RawTag{},
+                                        other._ref._offset}} {}
+
+    OptionStorage& operator=(const OptionStorage& other) {
+        if (other.is_some()) {
+            _ref = other._ref;
+        } else {
+            _ref._offset = other._ref._offset;
+        }
+        return *this;
+    }
+
+  private:
+    static constexpr Offset NicheOffset = std::numeric_limits<Offset>::min();
+
+    Handle _ref;
+};
+
+} // namespace better
@@ -0,0 +1,244 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "atomic_wait.hpp"
+#include "option.hpp"
+#include "result.hpp"
+
+#include "storage/raw.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace better {
+
+template <class T, class E>
+struct OneshotSender;
+
+template <class T, class E>
+struct OneshotReceiver;
+
+namespace detail {
+
+// Sender and receiver share one allocation with the Result stored inline
+template <class T, class E>
+struct OneshotState {
+    enum Status : std::uint32_t {
+        Empty = 0,
+        Ready = 1,
+        // sender was dropped without sending
+        Closed = 2,
+        // receiver took the value
+        Taken = 3,
+        // receiver sleeps on the status word; sender must wake it
+        Waiting = 4,
+    };
+
+    std::atomic<std::uint32_t> status = Empty;
+    std::atomic<std::uint32_t> refs = 2;
+    RawStorage<Result<T, E>> value;
+
+    ~OneshotState() {
+        if (status.load(std::memory_order_acquire) == Ready) {
+            std::destroy_at(value.get_raw());
+        }
+    }
+
+    void release() noexcept {
+        if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    // Never blocks: one exchange and at most one wake
+    void publish(std::uint32_t final_status) noexcept {
+        if (status.exchange(final_status, std::memory_order_acq_rel) &
+            Waiting) {
+            atomic_notify_all(status);
+        }
+    }
+};
+
+} // namespace detail
+
+// Single-use channel carrying Result<T, E>: a lightweight replacement for
+// std::promise / std::future pair. Sending is wait-free
+template <class T, class E>
+std::pair<OneshotSender<T, E>, OneshotReceiver<T, E>> oneshot() {
+    auto* state = new detail::OneshotState<T, E>{};
+    return {OneshotSender<T, E>{state}, OneshotReceiver<T, E>{state}};
+}
+
+template <class T, class E>
+struct OneshotSender {
+    OneshotSender(OneshotSender&& other) noexcept
+        : _state{std::exchange(other._state, nullptr)} {}
+
+    OneshotSender& operator=(OneshotSender&& other) noexcept {
+        OneshotSender tmp{std::move(other)};
+        std::swap(_state, tmp._state);
+        return *this;
+    }
+
+    OneshotSender(const OneshotSender&) = delete;
+    OneshotSender& operator=(const OneshotSender&) = delete;
+
+    // Dropping the sender without sending closes the channel
+    ~OneshotSender() {
+        if (_state != nullptr) {
+            _state->publish(State::Closed);
+            _state->release();
+        }
+    }
+
+    void send(Result<T, E> result) && {
+        emplace(std::move(result));
+    }
+
+    template <class... Args>
+    void send_ok(Args&&... args) && {
+        emplace(Ok, std::forward<Args>(args)...);
+    }
+
+    template <class... Args>
+    void send_err(Args&&... args) && {
+        emplace(Err, std::forward<Args>(args)...);
+    }
+
+  private:
+    using State = detail::OneshotState<T, E>;
+
+    friend std::pair<OneshotSender, OneshotReceiver<T, E>> oneshot<T, E>();
+
+    explicit OneshotSender(State* state) noexcept : _state{state} {}
+
+    template <class... Args>
+    void emplace(Args&&... args) {
+        State* const state = std::exchange(_state, nullptr);
+        try {
+            new (state->value.get_bytes())
+                Result<T, E>(std::forward<Args>(args)...);
+        } catch (...) {
+            state->publish(State::Closed);
+            state->release();
+            throw;
+        }
+        state->publish(State::Ready);
+        state->release();
+    }
+
+    State* _state;
+};
+
+template <class T, class E>
+struct OneshotReceiver {
+    OneshotReceiver(OneshotReceiver&& other) noexcept
+        : _state{std::exchange(other._state, nullptr)} {}
+
+    OneshotReceiver& operator=(OneshotReceiver&& other) noexcept {
+        OneshotReceiver tmp{std::move(other)};
+        std::swap(_state, tmp._state);
+        return *this;
+    }
+
+    OneshotReceiver(const OneshotReceiver&) = delete;
+    OneshotReceiver& operator=(const OneshotReceiver&) = delete;
+
+    ~OneshotReceiver() {
+        if (_state != nullptr) {
+            _state->release();
+        }
+    }
+
+    // None if nothing has been sent yet, the sender is gone
+    // or the value was already received
+    Option<Result<T, E>> try_recv() {
+        if (status() == State::Ready) {
+            return take();
+        }
+        return None;
+    }
+
+    // True once waiting makes no sense: the sender is gone without
+    // sending or the value was already received
+    bool is_closed() const noexcept {
+        const auto s = status();
+        return s == State::Closed || s == State::Taken;
+    }
+
+    // Blocks until the value arrives.
+    // None if the sender was dropped without sending
+    Option<Result<T, E>> recv() {
+        while (prepare_wait()) {
+            detail::atomic_wait(_state->status,
+                                State::Empty | State::Waiting);
+        }
+        return try_recv();
+    }
+
+    // None on timeout, like try_recv() otherwise
+    template <class Rep, class Period>
+    Option<Result<T, E>> recv_for(std::chrono::duration<Rep, Period> timeout) {
+        if (prepare_wait()) {
+            detail::atomic_wait_for(_state->status,
+                                    State::Empty | State::Waiting, timeout);
+        }
+        return try_recv();
+    }
+
+  private:
+    using State = detail::OneshotState<T, E>;
+
+    friend std::pair<OneshotSender<T, E>, OneshotReceiver> oneshot<T, E>();
+
+    explicit OneshotReceiver(State* state) noexcept : _state{state} {}
+
+    std::uint32_t status() const noexcept {
+        return _state->status.load(std::memory_order_acquire) &
+               ~std::uint32_t{State::Waiting};
+    }
+
+    // Marks receiver as sleeping. False if there is nothing to wait for
+    bool prepare_wait() noexcept {
+        std::uint32_t expected = State::Empty;
+        return _state->status.compare_exchange_strong(
+                   expected, State::Empty | State::Waiting,
+                   std::memory_order_acq_rel) ||
+               expected == (State::Empty | State::Waiting);
+    }
+
+    Option<Result<T, E>> take() {
+        Result<T, E>* const value = _state->value.get_raw();
+        Option<Result<T, E>> result{Some, std::move(*value)};
+        std::destroy_at(value);
+        _state->status.store(State::Taken, std::memory_order_release);
+        return result;
+    }
+
+    State* _state;
+};
+
+} // namespace better
@@ -22,11 +22,14 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 #include "ref.hpp"
+#include "relocate.hpp"
 #include "tags.hpp"
 #include "void.hpp"
 
 #include "invoke_with.hpp"
 
+#include "storage/enum.hpp"
+#include "storage/flag.hpp"
 #include "storage/generic_option.hpp"
 #include "storage/ref.hpp"
 
@@ -42,6 +45,22 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace better {
 
+template <class T>
+struct Option;
+
+template <class T>
+constexpr bool IsOption = false;
+template <class T>
+constexpr bool IsOption<Option<T>> = true;
+
+namespace detail {
+// Shared None instance to return by reference
+template <class Opt>
+struct NoneInstance {
+    static inline const Opt value{None};
+};
+} // namespace detail
+
 template <class T>
 struct Option : protected OptionStorage<T> {
 
@@ -250,6 +269,21 @@ struct Option : protected OptionStorage<T> {
         return Option(*this).or_else(std::forward<F>(f));
     }
 
+    // Option<Option<U>> -> Option<U>
+    // Inner Option is returned in place, without copies
+    const T& flatten() const&
+        requires IsOption<T>
+    {
+        return is_some() ? this->unwrap_unsafe()
+                         : detail::NoneInstance<T>::value;
+    }
+
+    T flatten() &&
+        requires IsOption<T>
+    {
+        return is_some() ? std::move(*this).unwrap_unsafe() : T{None};
+    }
+
     auto operator<=>(const Option& other) const
         requires std::three_way_comparable<T>
     {
@@ -271,14 +305,39 @@ struct Option : protected OptionStorage<T> {
     }
 
   private:
+    template <class, class>
+    friend struct Result;
+
+    friend struct option_flag_traits<Option<T>>;
+
     explicit Option(Base&& base) noexcept(
         std::is_nothrow_move_constructible_v<Base>)
         : Base{std::move(base)} {}
+
+    explicit Option(NicheTag niche) noexcept : Base{niche} {}
 };
 
 template <class T>
 Option(SomeTag, T) -> Option<T>;
 
+// Option<Option<T>> keeps its None in the spare state of the inner storage
+// (bool flag, Ref null pointer...) and adds no extra bytes
+template <class T>
+    requires std::is_constructible_v<OptionStorage<T>, NicheTag>
+struct option_flag_traits<Option<T>> {
+    static void set_none(std::byte* bytes) noexcept {
+        new (bytes) Option<T>{NicheTag{}};
+    }
+    static bool is_none(const std::byte* bytes) noexcept {
+        return std::launder(reinterpret_cast<const Option<T>*>(bytes))
+            ->is_niche();
+    }
+};
+
+// Option is just a payload and a flag, so it can be memcpy-ed if payload can
+template <class T>
+struct is_trivially_relocatable<Option<T>> : is_trivially_relocatable<T> {};
+
 static_assert(sizeof(Option<Void>) == sizeof(bool));
 
 } // namespace better
\ No newline at end of file
@@ -0,0 +1,503 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "atomic_wait.hpp"
+#include "invoke_with.hpp"
+#include "option.hpp"
+#include "result.hpp"
+#include "void.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <ranges>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace better::par {
+
+namespace detail {
+
+// Chase-Lev work-stealing deque of one-word items, fixed capacity.
+// Owner pushes and pops at the bottom, thieves steal from the top.
+// Memory orders follow Le et al., "Correct and Efficient Work-Stealing
+// for Weak Memory Models"
+struct ChaseLevDeque {
+    // Range splitting is binary, so there are never more items
+    // than bits in an index
+    static constexpr std::int64_t Capacity = 64;
+
+    // Owner only. False if full
+    bool push(std::uint64_t item) noexcept {
+        const auto b = _bottom.load(std::memory_order_relaxed);
+        const auto t = _top.load(std::memory_order_acquire);
+        if (b - t >= Capacity) {
+            return false;
+        }
+        _items[b % Capacity].store(item, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        _bottom.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Owner only. Newest item first
+    Option<std::uint64_t> pop() noexcept {
+        const auto b = _bottom.load(std::memory_order_relaxed) - 1;
+        _bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto t = _top.load(std::memory_order_relaxed);
+        if (t > b) {
+            _bottom.store(b + 1, std::memory_order_relaxed);
+            return None;
+        }
+        const auto item = _items[b % Capacity].load(std::memory_order_relaxed);
+        if (t == b) {
+            // last item: race with thieves for it
+            const bool won = _top.compare_exchange_strong(
+                t, t + 1, std::memory_order_seq_cst,
+                std::memory_order_relaxed);
+            _bottom.store(b + 1, std::memory_order_relaxed);
+            if (!won) {
+                return None;
+            }
+        }
+        return {Some, item};
+    }
+
+    // Any thread. Oldest item first; None if empty or lost a race
+    Option<std::uint64_t> steal() noexcept {
+        auto t = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const auto b = _bottom.load(std::memory_order_acquire);
+        if (t >= b) {
+            return None;
+        }
+        const auto item = _items[t % Capacity].load(std::memory_order_relaxed);
+        if (!_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return None;
+        }
+        return {Some, item};
+    }
+
+  private:
+    alignas(64) std::atomic<std::int64_t> _top = 0;
+    alignas(64) std::atomic<std::int64_t> _bottom = 0;
+    std::atomic<std::uint64_t> _items[Capacity];
+};
+
+// Index range packed into one word, so deques can hold it
+inline std::uint64_t pack(std::uint32_t begin, std::uint32_t end) noexcept {
+    return (std::uint64_t{begin} << 32) | end;
+}
+
+inline std::pair<std::uint32_t, std::uint32_t>
+unpack(std::uint64_t range) noexcept {
+    return {static_cast<std::uint32_t>(range >> 32),
+            static_cast<std::uint32_t>(range)};
+}
+
+// One parallel loop: body(ctx, worker, begin, end) over [0, size)
+struct Loop {
+    void* ctx;
+    void (*body)(void* ctx, std::size_t worker, std::size_t begin,
+                 std::size_t end);
+    std::size_t base;
+    std::size_t grain;
+    const std::atomic<bool>* cancelled;
+    std::atomic<std::size_t> remaining;
+};
+
+} // namespace detail
+
+// Work-stealing pool for parallel loops.
+// The calling thread takes part in its loop, so a pool with
+// `workers` threads runs loops on workers + 1 threads.
+// Loops started from inside a loop body run sequentially
+struct Pool {
+    explicit Pool(std::size_t workers) : _deques(workers + 1) {
+        for (std::size_t i = 0; i < workers; ++i) {
+            _threads.emplace_back([this, i] { work(i); });
+        }
+    }
+
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+
+    ~Pool() {
+        _stop.store(true);
+        _epoch.fetch_add(1);
+        better::detail::atomic_notify_all(_epoch);
+        for (auto& thread : _threads) {
+            thread.join();
+        }
+    }
+
+    // Threads taking part in a loop
+    std::size_t participants() const noexcept { return _deques.size(); }
+
+    // Calls body(worker, begin, end) for disjoint chunks covering
+    // [0, size). Chunks are split in halves down to `grain` elements;
+    // idle threads steal the largest pending halves.
+    // Chunks are skipped once `cancelled` is set
+    template <class Body>
+    void for_each_chunk(std::size_t size, std::size_t grain,
+                        const std::atomic<bool>& cancelled, Body&& body) {
+        if (size == 0) {
+            return;
+        }
+        if (_inside_loop) {
+            body(std::size_t{0}, std::size_t{0}, size);
+            return;
+        }
+        std::lock_guard lock{_loop_mutex};
+        constexpr std::size_t MaxBlock = UINT32_MAX;
+        for (std::size_t base = 0; base < size; base += MaxBlock) {
+            detail::Loop loop{
+                .ctx = &body,
+                .body = [](void* ctx, std::size_t worker, std::size_t begin,
+                           std::size_t end) {
+                    (*static_cast<std::remove_reference_t<Body>*>(ctx))(
+                        worker, begin, end);
+                },
+                .base = base,
+                .grain = std::max<std::size_t>(grain, 1),
+                .cancelled = &cancelled,
+                .remaining = std::min(MaxBlock, size - base),
+            };
+            run(loop);
+        }
+    }
+
+  private:
+    static inline thread_local bool _inside_loop = false;
+
+    void run(detail::Loop& loop) {
+        const std::size_t self = _deques.size() - 1;
+        _deques[self].push(
+            detail::pack(0, static_cast<std::uint32_t>(loop.remaining)));
+        _loop.store(&loop);
+        _epoch.fetch_add(1);
+        if (_sleeping.load() != 0) {
+            better::detail::atomic_notify_all(_epoch);
+        }
+
+        _inside_loop = true;
+        participate(loop, self);
+        _inside_loop = false;
+
+        // workers may still look at the loop: wait until they leave
+        _loop.store(nullptr);
+        while (_active.load() != 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    void participate(detail::Loop& loop, std::size_t self) {
+        while (loop.remaining.load(std::memory_order_acquire) != 0) {
+            auto range = _deques[self].pop();
+            for (std::size_t i = 1; range.is_none() && i < _deques.size();
+                 ++i) {
+                range = _deques[(self + i) % _deques.size()].steal();
+            }
+            if (range.is_some()) {
+                process(loop, self, range.unwrap());
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void process(detail::Loop& loop, std::size_t self, std::uint64_t range) {
+        auto [begin, end] = detail::unpack(range);
+        // keep the left half, leave the right half for thieves
+        while (end - begin > loop.grain) {
+            const std::uint32_t mid = begin + (end - begin) / 2;
+            if (!_deques[self].push(detail::pack(mid, end))) {
+                break;
+            }
+            end = mid;
+        }
+        if (!loop.cancelled->load(std::memory_order_relaxed)) {
+            loop.body(loop.ctx, self, loop.base + begin, loop.base + end);
+        }
+        loop.remaining.fetch_sub(end - begin, std::memory_order_acq_rel);
+    }
+
+    void work(std::size_t self) {
+        _inside_loop = true;
+        for (;;) {
+            const std::uint32_t epoch = _epoch.load();
+            if (_stop.load()) {
+                return;
+            }
+            _active.fetch_add(1);
+            if (detail::Loop* loop = _loop.load()) {
+                participate(*loop, self);
+            }
+            _active.fetch_sub(1);
+
+            _sleeping.fetch_add(1);
+            better::detail::atomic_wait(_epoch, epoch);
+            _sleeping.fetch_sub(1);
+        }
+    }
+
+    std::vector<detail::ChaseLevDeque> _deques;
+    std::vector<std::thread> _threads;
+    std::mutex _loop_mutex;
+    std::atomic<detail::Loop*> _loop = nullptr;
+    std::atomic<std::uint32_t> _epoch = 0;
+    std::atomic<std::uint32_t> _sleeping = 0;
+    std::atomic<std::uint32_t> _active = 0;
+    std::atomic<bool> _stop = false;
+};
+
+// Shared pool with one thread per core (the caller counts as one)
+inline Pool& default_pool() {
+    static Pool pool{std::max(std::thread::hardware_concurrency(), 1u) - 1};
+    return pool;
+}
+
+enum class Order {
+    // Results keep the order of the input
+    Preserve,
+    // Results come in any order, without the ordering pass
+    Any,
+};
+
+namespace detail {
+
+// About 8 chunks per thread: enough to balance, few enough to be cheap
+inline std::size_t auto_grain(const Pool& pool, std::size_t size) noexcept {
+    return std::max<std::size_t>(1, size / (8 * pool.participants()));
+}
+
+// First exception thrown by an element stops the loop
+// and is rethrown in the calling thread
+struct FirstFailure {
+    std::atomic<bool> cancelled = false;
+    std::mutex mutex;
+    std::exception_ptr exception;
+
+    void capture() {
+        std::lock_guard lock{mutex};
+        if (!exception) {
+            exception = std::current_exception();
+        }
+        cancelled.store(true, std::memory_order_relaxed);
+    }
+
+    void rethrow() {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+};
+
+template <class R>
+using Element = std::ranges::range_reference_t<R>;
+
+template <class F, class R>
+using ErrorOf = std::decay_t<decltype(std::declval<std::invoke_result_t<
+                                          F&, Element<R>>>()
+                                          .unwrap_err())>;
+
+} // namespace detail
+
+// f(element) for every element; results in input order.
+// void-returning f produces Void, like Result::map does
+template <std::ranges::random_access_range R, class F>
+    requires std::ranges::sized_range<R> &&
+             IsInvocableWith<F&, detail::Element<R>>
+auto par_map(Pool& pool, R&& range, F&& f) {
+    using U = std::decay_t<decltype(invoke_with(
+        f, std::declval<detail::Element<R>>()))>;
+    const auto size = static_cast<std::size_t>(std::ranges::size(range));
+    const auto first = std::ranges::begin(range);
+
+    std::vector<Option<U>> slots;
+    slots.reserve(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        slots.emplace_back(None);
+    }
+    detail::FirstFailure failure;
+    pool.for_each_chunk(
+        size, detail::auto_grain(pool, size), failure.cancelled,
+        [&](std::size_t, std::size_t begin, std::size_t end) {
+            try {
+                for (std::size_t i = begin; i < end; ++i) {
+                    slots[i].insert(invoke_with(
+                        f, first[static_cast<std::ptrdiff_t>(i)]));
+                }
+            } catch (...) {
+                failure.capture();
+            }
+        });
+    failure.rethrow();
+
+    std::vector<U> out;
+    out.reserve(size);
+    for (auto& slot : slots) {
+        out.push_back(std::move(slot).unwrap());
+    }
+    return out;
+}
+
+// Keeps Some results of f(element)
+template <std::ranges::random_access_range R, class F>
+    requires std::ranges::sized_range<R> &&
+             IsOption<std::decay_t<
+                 std::invoke_result_t<F&, detail::Element<R>>>>
+auto par_filter_map(Pool& pool, R&& range, F&& f,
+                    Order order = Order::Preserve) {
+    using Opt = std::decay_t<std::invoke_result_t<F&, detail::Element<R>>>;
+    using U = std::decay_t<decltype(std::declval<Opt>().unwrap())>;
+    const auto size = static_cast<std::size_t>(std::ranges::size(range));
+    const auto first = std::ranges::begin(range);
+
+    // Preserve: one bucket per chunk start, concatenated in index order.
+    // Any: one bucket per thread
+    std::vector<std::pair<std::size_t, std::vector<U>>> chunks;
+    std::vector<std::vector<U>> per_thread(pool.participants());
+    std::mutex chunks_mutex;
+    detail::FirstFailure failure;
+
+    pool.for_each_chunk(
+        size, detail::auto_grain(pool, size), failure.cancelled,
+        [&](std::size_t worker, std::size_t begin, std::size_t end) {
+            try {
+                std::vector<U> local;
+                auto& out = order == Order::Any ? per_thread[worker] : local;
+                for (std::size_t i = begin; i < end; ++i) {
+                    auto value = f(first[static_cast<std::ptrdiff_t>(i)]);
+                    if (value.is_some()) {
+                        out.push_back(std::move(value).unwrap());
+                    }
+                }
+                if (order == Order::Preserve && !local.empty()) {
+                    std::lock_guard lock{chunks_mutex};
+                    chunks.emplace_back(begin, std::move(local));
+                }
+            } catch (...) {
+                failure.capture();
+            }
+        });
+    failure.rethrow();
+
+    std::vector<U> out;
+    if (order == Order::Preserve) {
+        std::sort(chunks.begin(), chunks.end(),
+                  [](const auto& a, const auto& b) { return a.first < b.first; });
+        for (auto& chunk : chunks) {
+            std::move(chunk.second.begin(), chunk.second.end(),
+                      std::back_inserter(out));
+        }
+    } else {
+        for (auto& bucket : per_thread) {
+            std::move(bucket.begin(), bucket.end(), std::back_inserter(out));
+        }
+    }
+    return out;
+}
+
+// Runs f(element) -> Result<Void, E> until the first Err.
+// Other threads stop at their next chunk once an Err is seen.
+// Returns that Err (the first one to be reported, not necessarily
+// the one with the smallest index)
+template <std::ranges::random_access_range R, class F>
+    requires std::ranges::sized_range<R> &&
+             std::is_same_v<std::decay_t<std::invoke_result_t<
+                                F&, detail::Element<R>>>,
+                            Result<Void, detail::ErrorOf<F, R>>>
+auto par_try_for_each(Pool& pool, R&& range, F&& f) {
+    using Res = std::decay_t<std::invoke_result_t<F&, detail::Element<R>>>;
+    const auto size = static_cast<std::size_t>(std::ranges::size(range));
+    const auto first = std::ranges::begin(range);
+
+    detail::FirstFailure failure;
+    Option<Res> first_err = None;
+    std::mutex err_mutex;
+
+    pool.for_each_chunk(
+        size, detail::auto_grain(pool, size), failure.cancelled,
+        [&](std::size_t, std::size_t begin, std::size_t end) {
+            try {
+                for (std::size_t i = begin; i < end; ++i) {
+                    if (failure.cancelled.load(std::memory_order_relaxed)) {
+                        return;
+                    }
+                    Res result = f(first[static_cast<std::ptrdiff_t>(i)]);
+                    if (result.is_err()) {
+                        std::lock_guard lock{err_mutex};
+                        if (first_err.is_none()) {
+                            first_err.insert(std::move(result));
+                        }
+                        failure.cancelled.store(true,
+                                                std::memory_order_relaxed);
+                        return;
+                    }
+                }
+            } catch (...) {
+                failure.capture();
+            }
+        });
+    failure.rethrow();
+
+    if (first_err.is_some()) {
+        return std::move(first_err).unwrap();
+    }
+    return Res{Ok};
+}
+
+template <std::ranges::random_access_range R, class F>
+auto par_map(R&& range, F&& f)
+    -> decltype(par_map(default_pool(), std::forward<R>(range),
+                        std::forward<F>(f))) {
+    return par_map(default_pool(), std::forward<R>(range), std::forward<F>(f));
+}
+
+template <std::ranges::random_access_range R, class F>
+auto par_filter_map(R&& range, F&& f, Order order = Order::Preserve)
+    -> decltype(par_filter_map(default_pool(), std::forward<R>(range),
+                               std::forward<F>(f), order)) {
+    return par_filter_map(default_pool(), std::forward<R>(range),
+                          std::forward<F>(f), order);
+}
+
+template <std::ranges::random_access_range R, class F>
+auto par_try_for_each(R&& range, F&& f)
+    -> decltype(par_try_for_each(default_pool(), std::forward<R>(range),
+                                 std::forward<F>(f))) {
+    return par_try_for_each(default_pool(), std::forward<R>(range),
+                            std::forward<F>(f));
+}
+
+} // namespace better::par
@@ -0,0 +1,209 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "option.hpp"
+#include "result.hpp"
+#include "void.hpp"
+
+#include "storage/raw.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace better {
+
+namespace detail {
+
+// Keeps producer and consumer indices on separate cache lines
+inline constexpr std::size_t CacheLine = 64;
+
+inline std::size_t queue_capacity(std::size_t capacity) {
+    if (capacity < 2) {
+        throw std::invalid_argument("queue capacity must be at least 2");
+    }
+    std::size_t rounded = 2;
+    while (rounded < capacity) {
+        rounded *= 2;
+    }
+    return rounded;
+}
+
+} // namespace detail
+
+// Bounded lock-free multi-producer multi-consumer queue
+// (Dmitry Vyukov's ring with per-slot sequence numbers).
+// Capacity is rounded up to a power of two
+template <class T>
+struct MpmcQueue {
+    // A slot is claimed before the value moves in or out of it;
+    // a throwing move would leave it claimed forever and stall the ring
+    static_assert(std::is_nothrow_move_constructible_v<T>,
+                  "MpmcQueue needs a nothrow move constructible T");
+
+    explicit MpmcQueue(std::size_t capacity)
+        : _mask{detail::queue_capacity(capacity) - 1},
+          _cells{std::make_unique<Cell[]>(_mask + 1)} {
+        for (std::size_t i = 0; i <= _mask; ++i) {
+            _cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    ~MpmcQueue() {
+        while (try_pop().is_some()) {
+        }
+    }
+
+    std::size_t capacity() const noexcept { return _mask + 1; }
+
+    // Err gives the value back if the queue is full
+    Result<Void, T> try_push(T value) {
+        std::size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = _cells[pos & _mask];
+            const std::size_t seq = cell.seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) -
+                              static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (_enqueue_pos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    new (cell.storage.get_bytes()) T(std::move(value));
+                    cell.seq.store(pos + 1, std::memory_order_release);
+                    return {Ok};
+                }
+            } else if (diff < 0) {
+                return {Err, std::move(value)};
+            } else {
+                pos = _enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // None if the queue is empty
+    Option<T> try_pop() {
+        std::size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = _cells[pos & _mask];
+            const std::size_t seq = cell.seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) -
+                              static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (_dequeue_pos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    T* const slot = cell.storage.get_raw();
+                    Option<T> value{Some, std::move(*slot)};
+                    std::destroy_at(slot);
+                    cell.seq.store(pos + _mask + 1, std::memory_order_release);
+                    return value;
+                }
+            } else if (diff < 0) {
+                return None;
+            } else {
+                pos = _dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+  private:
+    struct Cell {
+        std::atomic<std::size_t> seq;
+        RawStorage<T> storage;
+    };
+
+    const std::size_t _mask;
+    const std::unique_ptr<Cell[]> _cells;
+    alignas(detail::CacheLine) std::atomic<std::size_t> _enqueue_pos = 0;
+    alignas(detail::CacheLine) std::atomic<std::size_t> _dequeue_pos = 0;
+};
+
+// Bounded lock-free queue for exactly one producer and one consumer.
+// Each side caches the other side's index and touches the shared one
+// only when the cached value says the queue is full (or empty)
+template <class T>
+struct SpscQueue {
+    // Same requirement as MpmcQueue, so that the two stay interchangeable
+    static_assert(std::is_nothrow_move_constructible_v<T>,
+                  "SpscQueue needs a nothrow move constructible T");
+
+    explicit SpscQueue(std::size_t capacity)
+        : _mask{detail::queue_capacity(capacity) - 1},
+          _slots{std::make_unique_for_overwrite<RawStorage<T>[]>(_mask + 1)} {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    ~SpscQueue() {
+        while (try_pop().is_some()) {
+        }
+    }
+
+    std::size_t capacity() const noexcept { return _mask + 1; }
+
+    // Producer side. Err gives the value back if the queue is full
+    Result<Void, T> try_push(T value) {
+        const std::size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head_cache > _mask) {
+            _head_cache = _head.load(std::memory_order_acquire);
+            if (tail - _head_cache > _mask) {
+                return {Err, std::move(value)};
+            }
+        }
+        new (_slots[tail & _mask].get_bytes()) T(std::move(value));
+        _tail.store(tail + 1, std::memory_order_release);
+        return {Ok};
+    }
+
+    // Consumer side. None if the queue is empty
+    Option<T> try_pop() {
+        const std::size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail_cache) {
+            _tail_cache = _tail.load(std::memory_order_acquire);
+            if (head == _tail_cache) {
+                return None;
+            }
+        }
+        T* const slot = _slots[head & _mask].get_raw();
+        Option<T> value{Some, std::move(*slot)};
+        std::destroy_at(slot);
+        _head.store(head + 1, std::memory_order_release);
+        return value;
+    }
+
+  private:
+    const std::size_t _mask;
+    const std::unique_ptr<RawStorage<T>[]> _slots;
+    // written by producer
+    alignas(detail::CacheLine) std::atomic<std::size_t> _tail = 0;
+    std::size_t _head_cache = 0;
+    // written by consumer
+    alignas(detail::CacheLine) std::atomic<std::size_t> _head = 0;
+    std::size_t _tail_cache = 0;
+};
+
+} // namespace better
@@ -0,0 +1,391 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "option.hpp"
+#include "ref.hpp"
+#include "relocate.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace better {
+
+// Weak references cost one more counter per allocation,
+// so they are opted in per type
+enum class RcWeak : bool { Disabled, Enabled };
+
+namespace detail {
+
+template <bool Atomic>
+struct RcCounter {
+    void increment() noexcept { _count.fetch_add(1, std::memory_order_relaxed); }
+
+    // True if this was the last reference
+    bool decrement() noexcept {
+        return _count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+
+    // Increments unless the count already dropped to zero
+    bool increment_if_alive() noexcept {
+        auto count = _count.load(std::memory_order_relaxed);
+        while (count != 0) {
+            if (_count.compare_exchange_weak(count, count + 1,
+                                             std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::size_t load() const noexcept {
+        return _count.load(std::memory_order_acquire);
+    }
+
+    // Weak count only: freezes the count while it is exactly one,
+    // so no Weak can appear until unlock()
+    bool try_lock_unique() noexcept {
+        std::size_t one = 1;
+        return _count.compare_exchange_strong(one, Locked,
+                                              std::memory_order_acquire,
+                                              std::memory_order_relaxed);
+    }
+
+    void unlock() noexcept { _count.store(1, std::memory_order_release); }
+
+    // Weak count only: waits out try_lock_unique() of another thread
+    void increment_unless_locked() noexcept {
+        auto count = _count.load(std::memory_order_relaxed);
+        while (true) {
+            if (count == Locked) {
+                count = _count.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (_count.compare_exchange_weak(count, count + 1,
+                                             std::memory_order_acquire,
+                                             std::memory_order_relaxed)) {
+                return;
+            }
+        }
+    }
+
+  private:
+    static constexpr std::size_t Locked = std::size_t(-1);
+
+    std::atomic<std::size_t> _count = 1;
+};
+
+template <>
+struct RcCounter<false> {
+    void increment() noexcept { ++_count; }
+    bool decrement() noexcept { return --_count == 0; }
+    bool increment_if_alive() noexcept { return _count != 0 && ++_count; }
+    std::size_t load() const noexcept { return _count; }
+
+    // Nothing can race within one thread
+    bool try_lock_unique() noexcept { return _count == 1; }
+    void unlock() noexcept {}
+    void increment_unless_locked() noexcept { ++_count; }
+
+  private:
+    std::size_t _count = 1;
+};
+
+struct NoWeakCounter {};
+
+// Counters and the object in one allocation.
+// With weak references the object may die before the block:
+// weak counts all Weak handles plus one for all strong ones together
+template <class T, bool Atomic, RcWeak W>
+struct RcBlock {
+    template <class... Args>
+    explicit RcBlock(Args&&... args) : value(std::forward<Args>(args)...) {}
+
+    ~RcBlock() {}
+
+    void release_strong() noexcept {
+        if (strong.decrement()) {
+            std::destroy_at(&value);
+            if constexpr (W == RcWeak::Enabled) {
+                release_weak();
+            } else {
+                delete this;
+            }
+        }
+    }
+
+    void release_weak() noexcept {
+        if (weak.decrement()) {
+            delete this;
+        }
+    }
+
+    RcCounter<Atomic> strong;
+    [[no_unique_address]] std::conditional_t<W == RcWeak::Enabled,
+                                             RcCounter<Atomic>, NoWeakCounter>
+        weak;
+    union {
+        T value;
+    };
+};
+
+} // namespace detail
+
+template <class T, bool Atomic, RcWeak W>
+struct BasicWeak;
+
+// Shared ownership of an immutable T in one pointer and one allocation.
+// Never null: a moved-from handle may only be destroyed or assigned to.
+// Use Rc<T> within one thread and Arc<T> across threads
+template <class T, bool Atomic, RcWeak W = RcWeak::Disabled>
+struct BasicRc {
+    static_assert(!std::is_reference_v<T> && !std::is_array_v<T>);
+
+    template <class... Args>
+        requires std::is_constructible_v<T, Args...>
+    static BasicRc make(Args&&... args) {
+        return BasicRc{new Block(std::forward<Args>(args)...)};
+    }
+
+    BasicRc(const BasicRc& other) noexcept : _block{other._block} {
+        _block->strong.increment();
+    }
+
+    BasicRc(BasicRc&& other) noexcept
+        : _block{std::exchange(other._block, nullptr)} {}
+
+    BasicRc& operator=(BasicRc other) noexcept {
+        std::swap(_block, other._block);
+        return *this;
+    }
+
+    ~BasicRc() {
+        if (_block != nullptr) {
+            _block->release_strong();
+        }
+    }
+
+    const T& get() const noexcept { return _block->value; }
+    const T& operator*() const noexcept { return get(); }
+    const T* operator->() const noexcept { return &get(); }
+
+    Ref<const T> ref() const noexcept { return Ref<const T>{get()}; }
+
+    // Number of strong handles; only a hint when other threads hold some
+    std::size_t use_count() const noexcept { return _block->strong.load(); }
+
+    // Same allocation, not just equal values
+    bool ptr_eq(const BasicRc& other) const noexcept {
+        return _block == other._block;
+    }
+
+    // Copy-on-write access: mutates in place when this is the only
+    // handle, otherwise detaches onto a fresh copy first
+    T& make_mut()
+        requires std::is_copy_constructible_v<T>
+    {
+        if (!is_unique()) {
+            *this = make(get());
+        }
+        return _block->value;
+    }
+
+    BasicWeak<T, Atomic, W> downgrade() const noexcept
+        requires(W == RcWeak::Enabled)
+    {
+        _block->weak.increment_unless_locked();
+        return BasicWeak<T, Atomic, W>{_block};
+    }
+
+  private:
+    using Block = detail::RcBlock<T, Atomic, W>;
+
+    friend struct BasicWeak<T, Atomic, W>;
+    friend struct OptionStorage<BasicRc>;
+
+    explicit BasicRc(Block* block) noexcept : _block{block} {}
+
+    bool is_unique() const noexcept {
+        if constexpr (W == RcWeak::Enabled) {
+            // A live Weak could upgrade and see the mutation.
+            // Weak count of one means there are none, and the lock keeps
+            // downgrade() out while strong is checked, so no upgrade()
+            // can slip in between the two loads
+            if (!_block->weak.try_lock_unique()) {
+                return false;
+            }
+            const bool unique = _block->strong.load() == 1;
+            _block->weak.unlock();
+            return unique;
+        } else {
+            // acquire: writes through the handles dropped before are visible
+            return _block->strong.load() == 1;
+        }
+    }
+
+    Block* _block;
+};
+
+// Non-owning handle: keeps the allocation, not the object
+template <class T, bool Atomic, RcWeak W>
+struct BasicWeak {
+    static_assert(W == RcWeak::Enabled);
+
+    BasicWeak(const BasicWeak& other) noexcept : _block{other._block} {
+        _block->weak.increment();
+    }
+
+    BasicWeak(BasicWeak&& other) noexcept
+        : _block{std::exchange(other._block, nullptr)} {}
+
+    BasicWeak& operator=(BasicWeak other) noexcept {
+        std::swap(_block, other._block);
+        return *this;
+    }
+
+    ~BasicWeak() {
+        if (_block != nullptr) {
+            _block->release_weak();
+        }
+    }
+
+    // None once every strong handle is gone
+    Option<BasicRc<T, Atomic, W>> upgrade() const noexcept {
+        if (!_block->strong.increment_if_alive()) {
+            return None;
+        }
+        return {Some, BasicRc<T, Atomic, W>{_block}};
+    }
+
+  private:
+    friend struct BasicRc<T, Atomic, W>;
+
+    explicit BasicWeak(detail::RcBlock<T, Atomic, W>* block) noexcept
+        : _block{block} {}
+
+    detail::RcBlock<T, Atomic, W>* _block;
+};
+
+template <class T, RcWeak W = RcWeak::Disabled>
+using Rc = BasicRc<T, false, W>;
+
+template <class T, RcWeak W = RcWeak::Disabled>
+using Arc = BasicRc<T, true, W>;
+
+template <class T>
+using WeakRc = BasicWeak<T, false, RcWeak::Enabled>;
+
+template <class T>
+using WeakArc = BasicWeak<T, true, RcWeak::Enabled>;
+
+template <class T, RcWeak W = RcWeak::Disabled, class... Args>
+Rc<T, W> make_rc(Args&&... args) {
+    return Rc<T, W>::make(std::forward<Args>(args)...);
+}
+
+template <class T, RcWeak W = RcWeak::Disabled, class... Args>
+Arc<T, W> make_arc(Args&&... args) {
+    return Arc<T, W>::make(std::forward<Args>(args)...);
+}
+
+// Null block pointer is None, address 1 is the niche of Option<Option<>>.
+// A handle is a single pointer, so swaps are plain pointer swaps
+template <class T, bool Atomic, RcWeak W>
+struct OptionStorage<BasicRc<T, Atomic, W>> {
+    using Handle = BasicRc<T, Atomic, W>;
+
+    bool is_some() const noexcept {
+        return _raw != nullptr && _raw != niche_ptr();
+    }
+
+    Handle& unwrap_unsafe() & noexcept { return _rc; }
+    const Handle& unwrap_unsafe() const& noexcept { return _rc; }
+    Handle&& unwrap_unsafe() && noexcept { return std::move(_rc); }
+
+    void swap(OptionStorage& other) noexcept { std::swap(_raw, other._raw); }
+
+    OptionStorage(NoneTag) noexcept : _raw{nullptr} {}
+
+    explicit OptionStorage(NicheTag) noexcept : _raw{niche_ptr()} {}
+    bool is_niche() const noexcept { return _raw == niche_ptr(); }
+
+    template <class... Args>
+        requires std::is_constructible_v<Handle, Args...>
+    OptionStorage(SomeTag, Args&&... args) noexcept(
+        std::is_nothrow_constructible_v<Handle, Args...>)
+        : _rc(std::forward<Args>(args)...) {}
+
+    OptionStorage(const OptionStorage& other) noexcept {
+        if (other.is_some()) {
+            std::construct_at(&_rc, other._rc);
+        } else {
+            _raw = other._raw;
+        }
+    }
+
+    // moves and resets other storage!
+    OptionStorage(OptionStorage&& other) noexcept : _raw{other._raw} {
+        if (other.is_some()) {
+            other._raw = nullptr;
+        }
+    }
+
+    OptionStorage& operator=(OptionStorage other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~OptionStorage() {
+        if (is_some()) {
+            std::destroy_at(&_rc);
+        }
+    }
+
+  private:
+    using Block = typename Handle::Block;
+
+    static Block* niche_ptr() noexcept {
+        return reinterpret_cast<Block*>(std::uintptr_t{1});
+    }
+
+    union {
+        Handle _rc;
+        Block* _raw;
+    };
+};
+
+template <class T, bool Atomic, RcWeak W>
+struct is_trivially_relocatable<BasicRc<T, Atomic, W>> : std::true_type {};
+
+template <class T, bool Atomic, RcWeak W>
+struct is_trivially_relocatable<BasicWeak<T, Atomic, W>> : std::true_type {};
+
+static_assert(sizeof(Arc<int>) == sizeof(void*));
+static_assert(sizeof(Option<Arc<int>>) == sizeof(void*));
+static_assert(sizeof(Option<Option<Rc<int>>>) == sizeof(void*));
+
+} // namespace better
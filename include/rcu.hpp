@@ -0,0 +1,273 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "option.hpp"
+#include "ref.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace better {
+
+namespace detail {
+
+// Epoch-based reclamation shared by all RcuSlots.
+// Each reader thread owns a record with the epoch it pinned (0 when it
+// is outside of read sections). Readers only store to their own record,
+// writers scan all records to find the oldest pinned epoch
+struct RcuDomain {
+    struct alignas(64) Record {
+        std::atomic<std::uint64_t> epoch = 0;
+        std::atomic<bool> in_use = true;
+        // nesting of read guards, touched by the owner only
+        std::uint32_t depth = 0;
+        Record* next = nullptr;
+    };
+
+    static RcuDomain& instance() noexcept {
+        static RcuDomain domain;
+        return domain;
+    }
+
+    // Record of the calling thread, registered on first use and given
+    // back for reuse when the thread exits
+    Record& local() {
+        thread_local Owner owner{acquire_record()};
+        return *owner.record;
+    }
+
+    void pin(Record& record) noexcept {
+        if (record.depth++ == 0) {
+            record.epoch.store(_epoch.load(std::memory_order_acquire),
+                               std::memory_order_relaxed);
+            // pairs with the fence in oldest_pinned(): either the writer
+            // sees this epoch or the reader sees the new pointer
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    void unpin(Record& record) noexcept {
+        if (--record.depth == 0) {
+            record.epoch.store(0, std::memory_order_release);
+        }
+    }
+
+    // Starts a new epoch; returns the one objects unlinked before the
+    // call belong to
+    std::uint64_t advance() noexcept {
+        return _epoch.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    // Objects retired in epochs below this are not reachable by readers
+    std::uint64_t oldest_pinned() const noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::uint64_t oldest = std::numeric_limits<std::uint64_t>::max();
+        for (Record* r = _head.load(std::memory_order_acquire); r != nullptr;
+             r = r->next) {
+            const auto epoch = r->epoch.load(std::memory_order_acquire);
+            if (epoch != 0) {
+                oldest = std::min(oldest, epoch);
+            }
+        }
+        return oldest;
+    }
+
+  private:
+    struct Owner {
+        Record* record;
+        ~Owner() {
+            record->epoch.store(0, std::memory_order_relaxed);
+            record->in_use.store(false, std::memory_order_release);
+        }
+    };
+
+    Record* acquire_record() {
+        for (Record* r = _head.load(std::memory_order_acquire); r != nullptr;
+             r = r->next) {
+            bool expected = false;
+            if (!r->in_use.load(std::memory_order_relaxed) &&
+                r->in_use.compare_exchange_strong(expected, true)) {
+                return r;
+            }
+        }
+        // records are never freed: the list only grows up to
+        // the peak number of reader threads
+        auto* record = new Record;
+        record->next = _head.load(std::memory_order_relaxed);
+        while (!_head.compare_exchange_weak(record->next, record)) {
+        }
+        return record;
+    }
+
+    std::atomic<Record*> _head = nullptr;
+    // starts at 1: 0 marks an unpinned record
+    std::atomic<std::uint64_t> _epoch = 1;
+};
+
+} // namespace detail
+
+template <class T>
+struct RcuSlot;
+
+// Read section over an RcuSlot: the value seen at read() stays alive
+// until the guard is dropped, even if writers replace it meanwhile.
+// Keep guards short: they hold back reclamation of every slot.
+// Not movable, like std::scoped_lock: the guard unpins the record of
+// the thread that created it and must be dropped on that thread
+template <class T>
+struct RcuGuard {
+    RcuGuard(const RcuGuard&) = delete;
+    RcuGuard& operator=(const RcuGuard&) = delete;
+
+    ~RcuGuard() { detail::RcuDomain::instance().unpin(*_record); }
+
+    Option<Ref<const T>> get() const noexcept {
+        if (_value == nullptr) {
+            return None;
+        }
+        return {Some, Ref<const T>{*_value}};
+    }
+
+    bool is_some() const noexcept { return _value != nullptr; }
+    bool is_none() const noexcept { return _value == nullptr; }
+
+  private:
+    friend struct RcuSlot<T>;
+
+    RcuGuard(detail::RcuDomain::Record& record, const T* value) noexcept
+        : _record{&record}, _value{value} {}
+
+    detail::RcuDomain::Record* _record;
+    const T* _value;
+};
+
+// Read-mostly Option<T>: readers take a guard with two plain stores,
+// a fence and a load, no read-modify-write on shared memory.
+// Writers swap the whole value and free replaced ones once no reader
+// can see them. Writers are serialized by a mutex
+template <class T>
+struct RcuSlot {
+    RcuSlot() noexcept = default;
+
+    explicit RcuSlot(T value) : _current{new T(std::move(value))} {}
+
+    RcuSlot(const RcuSlot&) = delete;
+    RcuSlot& operator=(const RcuSlot&) = delete;
+
+    // No guards of this slot may be alive
+    ~RcuSlot() {
+        delete _current.load(std::memory_order_relaxed);
+        for (auto& retired : _retired) {
+            delete retired.value;
+        }
+    }
+
+    RcuGuard<T> read() const {
+        auto& domain = detail::RcuDomain::instance();
+        auto& record = domain.local();
+        domain.pin(record);
+        return RcuGuard<T>{record, _current.load(std::memory_order_acquire)};
+    }
+
+    // Publishes a new value; readers see either the old or the new one
+    template <class... Args>
+    void emplace(Args&&... args) {
+        replace(new T(std::forward<Args>(args)...));
+    }
+
+    void store(T value) { emplace(std::move(value)); }
+
+    // Publishes None
+    void reset() { replace(nullptr); }
+
+    // Blocks until every value replaced so far is freed.
+    // Deadlocks if the calling thread holds a guard
+    void synchronize() {
+        std::lock_guard lock{_write_mutex};
+        while (!_retired.empty()) {
+            reclaim();
+            if (!_retired.empty()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // Frees replaced values no reader can see any more, without waiting
+    // for the rest. Writes do it on their own: read-mostly users call it
+    // now and then. Returns the number of values still retired
+    std::size_t try_reclaim() {
+        std::lock_guard lock{_write_mutex};
+        reclaim();
+        return _retired.size();
+    }
+
+    // Replaced values not freed yet
+    std::size_t retired_count() const {
+        std::lock_guard lock{_write_mutex};
+        return _retired.size();
+    }
+
+  private:
+    struct Retired {
+        const T* value;
+        std::uint64_t epoch;
+    };
+
+    void replace(const T* value) {
+        std::unique_ptr<const T> owned{value};
+        std::lock_guard lock{_write_mutex};
+        // nothing may throw once the old value is unlinked
+        _retired.reserve(_retired.size() + 1);
+        const T* old = _current.exchange(owned.release(),
+                                         std::memory_order_acq_rel);
+        if (old != nullptr) {
+            _retired.push_back(
+                Retired{old, detail::RcuDomain::instance().advance()});
+        }
+        reclaim();
+    }
+
+    void reclaim() {
+        const auto oldest = detail::RcuDomain::instance().oldest_pinned();
+        std::erase_if(_retired, [oldest](const Retired& retired) {
+            if (retired.epoch < oldest) {
+                delete retired.value;
+                return true;
+            }
+            return false;
+        });
+    }
+
+    std::atomic<const T*> _current = nullptr;
+    mutable std::mutex _write_mutex;
+    std::vector<Retired> _retired;
+};
+
+} // namespace better
@@ -0,0 +1,99 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace better {
+
+// Relocation = move-construct into new place + destroy the source.
+// For trivially relocatable types it is just a memcpy of the object bytes
+// and the source is considered dead afterwards (no destructor call).
+//
+// Every trivially copyable type is trivially relocatable.
+// Other types may opt in by specializing this trait.
+template <class T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <class T>
+constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+// Standard types that hold no pointers into themselves.
+// Note: std::string is NOT here: libstdc++ SSO string points into itself
+template <class T>
+struct is_trivially_relocatable<std::unique_ptr<T>> : std::true_type {};
+
+template <class T>
+struct is_trivially_relocatable<std::shared_ptr<T>> : std::true_type {};
+
+template <class T>
+struct is_trivially_relocatable<std::vector<T>> : std::true_type {};
+
+// Relocates single object from `src` to uninitialized `dest`.
+// `src` is uninitialized memory afterwards
+template <class T>
+T* relocate_at(T* src, T* dest) noexcept(
+    is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>) {
+    if constexpr (is_trivially_relocatable_v<T>) {
+        std::memcpy(static_cast<void*>(dest), static_cast<const void*>(src),
+                    sizeof(T));
+        return std::launder(dest);
+    } else {
+        T* result = std::construct_at(dest, std::move(*src));
+        std::destroy_at(src);
+        return result;
+    }
+}
+
+// Relocates [first, first + n) into uninitialized memory starting at `dest`.
+// Source range becomes uninitialized.
+// Ranges may overlap only if dest <= first (compaction)
+// Returns end of the destination range
+template <class T>
+T* relocate_n(T* first, std::size_t n, T* dest) noexcept(
+    is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>) {
+    if constexpr (is_trivially_relocatable_v<T>) {
+        if (n != 0) {
+            std::memmove(static_cast<void*>(dest),
+                         static_cast<const void*>(first), n * sizeof(T));
+        }
+        return dest + n;
+    } else {
+        for (std::size_t i = 0; i < n; ++i) {
+            relocate_at(first + i, dest + i);
+        }
+        return dest + n;
+    }
+}
+
+template <class T>
+T* uninitialized_relocate(T* first, T* last, T* dest) noexcept(
+    noexcept(relocate_n(first, 0, dest))) {
+    return relocate_n(first, static_cast<std::size_t>(last - first), dest);
+}
+
+} // namespace better
@@ -22,6 +22,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 #include "invoke_with.hpp"
+#include "relocate.hpp"
+#include "storage/enum.hpp"
+#include "storage/flag.hpp"
 #include "storage/generic_result.hpp"
 
 #include <stdexcept>
@@ -42,6 +45,13 @@ struct Result : protected ResultStorage<T, E> {
                   "built-in reference types cannot be supported as a type "
                   "parameter. Use better::Ref");
 
+  private:
+    static constexpr bool IsOkOptionLayout =
+        std::is_same_v<E, Void> && !std::is_same_v<T, Void>;
+    static constexpr bool IsErrOptionLayout =
+        std::is_same_v<T, Void> && !std::is_same_v<E, Void>;
+
+  public:
     template <class... Args>
     Result(OkTag, Args&&... args)
         : ResultStorage<T, E>{Ok, std::forward<Args>(args)...} {}
@@ -50,6 +60,16 @@ struct Result : protected ResultStorage<T, E> {
     Result(ErrTag, Args&&... args)
         : ResultStorage<T, E>{Err, std::forward<Args>(args)...} {}
 
+    // Reinterprets Option<T> as Result<T, Void>: None becomes Err
+    explicit Result(Option<T>&& opt)
+        requires IsOkOptionLayout
+        : ResultStorage<T, E>{static_cast<OptionStorage<T>&&>(opt)} {}
+
+    // Reinterprets Option<E> as Result<Void, E>: None becomes Ok
+    explicit Result(Option<E>&& opt)
+        requires IsErrOptionLayout
+        : ResultStorage<T, E>{static_cast<OptionStorage<E>&&>(opt)} {}
+
     using ResultStorage<T, E>::is_ok;
 
     bool is_err() const { return !this->is_ok(); }
@@ -134,7 +154,7 @@ struct Result : protected ResultStorage<T, E> {
             return Result<R, E>{
                 Ok, invoke_with(std::forward<F>(f), this->unwrap_unsafe())};
         } else {
-            return Result<R, E>{Err, *this->as_err_storage().get_raw()};
+            return Result<R, E>{Err, this->unwrap_err_unsafe()};
         }
     }
 
@@ -188,8 +208,45 @@ struct Result : protected ResultStorage<T, E> {
         }
     }
 
+    // Borrow Ok value without copying.
+    // Option<Ref<...>> is pointer-sized thanks to niche optimization
+    auto ok_ref() & {
+        using RefT =
+            Ref<std::remove_reference_t<decltype(this->unwrap_unsafe())>>;
+        return this->is_ok() ? Option<RefT>{Some, RefT{this->unwrap_unsafe()}}
+                             : Option<RefT>{None};
+    }
+
+    auto ok_ref() const& {
+        using RefT =
+            Ref<std::remove_reference_t<decltype(this->unwrap_unsafe())>>;
+        return this->is_ok() ? Option<RefT>{Some, RefT{this->unwrap_unsafe()}}
+                             : Option<RefT>{None};
+    }
+
+    // Borrow Err value without copying
+    auto err_ref() & {
+        using RefE =
+            Ref<std::remove_reference_t<decltype(this->unwrap_err_unsafe())>>;
+        return this->is_err()
+                   ? Option<RefE>{Some, RefE{this->unwrap_err_unsafe()}}
+                   : Option<RefE>{None};
+    }
+
+    auto err_ref() const& {
+        using RefE =
+            Ref<std::remove_reference_t<decltype(this->unwrap_err_unsafe())>>;
+        return this->is_err()
+                   ? Option<RefE>{Some, RefE{this->unwrap_err_unsafe()}}
+                   : Option<RefE>{None};
+    }
+
+    // Result<T, Void> and Result<Void, E> share layout with Option,
+    // so ok() and err() just move the storage as a whole
     Option<T> ok() && {
-        if (this->is_ok()) {
+        if constexpr (IsOkOptionLayout) {
+            return Option<T>{std::move(this->as_option_storage())};
+        } else if (this->is_ok()) {
             return Option<T>{Some, std::move(this->unwrap_unsafe())};
         } else {
             return Option<T>{None};
@@ -197,7 +254,9 @@ struct Result : protected ResultStorage<T, E> {
     }
 
     Option<T> ok() const& {
-        if (this->is_ok()) {
+        if constexpr (IsOkOptionLayout) {
+            return Option<T>{OptionStorage<T>{this->as_option_storage()}};
+        } else if (this->is_ok()) {
             return Option<T>{Some, this->unwrap_unsafe()};
         } else {
             return Option<T>{None};
@@ -205,7 +264,9 @@ struct Result : protected ResultStorage<T, E> {
     }
 
     Option<E> err() && {
-        if (this->is_err()) {
+        if constexpr (IsErrOptionLayout) {
+            return Option<E>{std::move(this->as_option_storage())};
+        } else if (this->is_err()) {
             return Option<E>{Some, std::move(this->unwrap_err_unsafe())};
         } else {
             return Option<E>{None};
@@ -213,7 +274,9 @@ struct Result : protected ResultStorage<T, E> {
     }
 
     Option<E> err() const& {
-        if (this->is_err()) {
+        if constexpr (IsErrOptionLayout) {
+            return Option<E>{OptionStorage<E>{this->as_option_storage()}};
+        } else if (this->is_err()) {
             return Option<E>{Some, this->unwrap_err_unsafe()};
         } else {
             return Option<E>{None};
@@ -327,9 +390,28 @@ struct Result : protected ResultStorage<T, E> {
     }
 
   private:
-    RawError<E>& as_err_storage() & { return *this; }
+    friend struct option_flag_traits<Result<T, E>>;
+
+    explicit Result(NicheTag niche) noexcept : ResultStorage<T, E>{niche} {}
+};
 
-    const RawError<E>& as_err_storage() const& { return *this; }
+// Option<Result<T, E>> keeps its None in the spare state of the
+// Result storage and adds no extra bytes
+template <class T, class E>
+    requires std::is_constructible_v<ResultStorage<T, E>, NicheTag>
+struct option_flag_traits<Result<T, E>> {
+    static void set_none(std::byte* bytes) noexcept {
+        new (bytes) Result<T, E>{NicheTag{}};
+    }
+    static bool is_none(const std::byte* bytes) noexcept {
+        return std::launder(reinterpret_cast<const Result<T, E>*>(bytes))
+            ->is_niche();
+    }
 };
 
+template <class T, class E>
+struct is_trivially_relocatable<Result<T, E>>
+    : std::bool_constant<is_trivially_relocatable_v<T> &&
+                         is_trivially_relocatable_v<E>> {};
+
 } // namespace better
\ No newline at end of file
@@ -0,0 +1,260 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "option.hpp"
+#include "ref.hpp"
+#include "result.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace better {
+
+// Sequence of Result<T, E> tuned for rare errors.
+// Ok values are stored densely, one sizeof(T) per element, so scans over
+// oks() are plain loops over contiguous memory. Errors are marked in a
+// bitmap and kept in a side table sorted by element index
+template <class T, class E>
+struct ResultVec {
+    struct ErrorEntry {
+        std::size_t index;
+        E error;
+    };
+
+  private:
+    template <bool Const>
+    struct Iterator;
+
+  public:
+    using reference = Result<Ref<T>, Ref<E>>;
+    using const_reference = Result<Ref<const T>, Ref<const E>>;
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    template <class... Args>
+    void push_ok(Args&&... args)
+        requires std::is_constructible_v<T, Args...>
+    {
+        reserve_bit();
+        _oks.emplace_back(std::forward<Args>(args)...);
+        mark(false);
+    }
+
+    template <class... Args>
+    void push_err(Args&&... args)
+        requires std::is_constructible_v<E, Args...>
+    {
+        reserve_bit();
+        _errors.push_back(
+            ErrorEntry{_size, E(std::forward<Args>(args)...)});
+        mark(true);
+    }
+
+    void push(Result<T, E>&& result) {
+        if (result.is_ok()) {
+            push_ok(std::move(result).unwrap());
+        } else {
+            push_err(std::move(result).unwrap_err());
+        }
+    }
+
+    void push(const Result<T, E>& result) {
+        if (result.is_ok()) {
+            push_ok(result.unwrap());
+        } else {
+            push_err(result.unwrap_err());
+        }
+    }
+
+    std::size_t size() const noexcept { return _size; }
+    bool empty() const noexcept { return _size == 0; }
+    std::size_t ok_count() const noexcept { return _oks.size(); }
+    std::size_t error_count() const noexcept { return _errors.size(); }
+
+    void reserve(std::size_t n) {
+        _oks.reserve(n);
+        _err_bits.reserve((n + 63) / 64);
+    }
+
+    void clear() noexcept {
+        _oks.clear();
+        _errors.clear();
+        _err_bits.clear();
+        _size = 0;
+    }
+
+    bool is_ok(std::size_t i) const noexcept {
+        return !((_err_bits[i / 64] >> (i % 64)) & 1);
+    }
+
+    bool is_err(std::size_t i) const noexcept { return !is_ok(i); }
+
+    // Unchecked access, O(log error_count()):
+    // Ok value lives at i minus number of errors before i
+    reference operator[](std::size_t i) noexcept {
+        const std::size_t errors_before = rank(i);
+        if (is_ok(i)) {
+            return reference{Ok, Ref{_oks[i - errors_before]}};
+        }
+        return reference{Err, Ref{_errors[errors_before].error}};
+    }
+
+    const_reference operator[](std::size_t i) const noexcept {
+        const std::size_t errors_before = rank(i);
+        if (is_ok(i)) {
+            return const_reference{Ok, Ref{_oks[i - errors_before]}};
+        }
+        return const_reference{Err, Ref{_errors[errors_before].error}};
+    }
+
+    // None for out of range indices
+    Option<reference> get(std::size_t i) noexcept {
+        if (i < _size) {
+            return {Some, (*this)[i]};
+        }
+        return None;
+    }
+
+    Option<const_reference> get(std::size_t i) const noexcept {
+        if (i < _size) {
+            return {Some, (*this)[i]};
+        }
+        return None;
+    }
+
+    // All Ok values in order, errors skipped
+    std::span<T> oks() noexcept { return _oks; }
+    std::span<const T> oks() const noexcept { return _oks; }
+
+    // All errors in order of their indices
+    std::span<const ErrorEntry> errors() const noexcept { return _errors; }
+
+    Option<Ref<const ErrorEntry>> first_error() const noexcept {
+        if (_errors.empty()) {
+            return None;
+        }
+        return {Some, Ref{_errors.front()}};
+    }
+
+    iterator begin() noexcept { return iterator{this, 0, 0, 0}; }
+    iterator end() noexcept {
+        return iterator{this, _size, _oks.size(), _errors.size()};
+    }
+    const_iterator begin() const noexcept {
+        return const_iterator{this, 0, 0, 0};
+    }
+    const_iterator end() const noexcept {
+        return const_iterator{this, _size, _oks.size(), _errors.size()};
+    }
+
+  private:
+    // Walks oks and errors side by side, no searches
+    template <bool Const>
+    struct Iterator {
+        using Vec = std::conditional_t<Const, const ResultVec, ResultVec>;
+
+        using iterator_concept = std::forward_iterator_tag;
+        using value_type = std::conditional_t<Const, const_reference, reference>;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+
+        value_type operator*() const noexcept {
+            if (_err < _vec->_errors.size() &&
+                _vec->_errors[_err].index == _index) {
+                return value_type{Err, Ref{_vec->_errors[_err].error}};
+            }
+            return value_type{Ok, Ref{_vec->_oks[_ok]}};
+        }
+
+        Iterator& operator++() noexcept {
+            if (_err < _vec->_errors.size() &&
+                _vec->_errors[_err].index == _index) {
+                ++_err;
+            } else {
+                ++_ok;
+            }
+            ++_index;
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            Iterator prev = *this;
+            ++*this;
+            return prev;
+        }
+
+        bool operator==(const Iterator& other) const noexcept {
+            return _index == other._index;
+        }
+
+      private:
+        friend struct ResultVec;
+
+        Iterator(Vec* vec, std::size_t index, std::size_t ok,
+                 std::size_t err) noexcept
+            : _vec{vec}, _index{index}, _ok{ok}, _err{err} {}
+
+        Vec* _vec = nullptr;
+        std::size_t _index = 0;
+        std::size_t _ok = 0;
+        std::size_t _err = 0;
+    };
+
+    // Number of errors with index less than i
+    std::size_t rank(std::size_t i) const noexcept {
+        const auto it = std::lower_bound(
+            _errors.begin(), _errors.end(), i,
+            [](const ErrorEntry& e, std::size_t idx) { return e.index < idx; });
+        return static_cast<std::size_t>(it - _errors.begin());
+    }
+
+    // Bitmap growth may throw, so it happens before the element is
+    // stored: mark() after a successful store cannot fail.
+    // Idempotent, a failed push leaves a spare word for the next one
+    void reserve_bit() {
+        if (_size == _err_bits.size() * 64) {
+            _err_bits.push_back(0);
+        }
+    }
+
+    void mark(bool is_err) noexcept {
+        if (is_err) {
+            _err_bits[_size / 64] |= std::uint64_t{1} << (_size % 64);
+        }
+        ++_size;
+    }
+
+    std::vector<T> _oks;
+    std::vector<ErrorEntry> _errors;
+    std::vector<std::uint64_t> _err_bits;
+    std::size_t _size = 0;
+};
+
+} // namespace better
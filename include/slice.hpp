@@ -0,0 +1,242 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "option.hpp"
+#include "ref.hpp"
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+namespace better {
+
+// Half-open index range [first, last) for Slice::get
+struct IndexRange {
+    std::size_t first;
+    std::size_t last;
+};
+
+// Pointer and length reference to contiguous elements: std::span with
+// Ref rules. Binds only to lvalue containers (or borrowed views such as
+// std::span), propagates const, and its data pointer is never null:
+// empty slices point at a dangling aligned address, like an empty Rust
+// slice. Null is then free to be None: Option<Slice<T>> is two words.
+// Every accessor is bounds checked and returns Option instead of
+// throwing
+template <class T>
+struct Slice final {
+    static_assert(!std::is_reference_v<T>);
+    static_assert(!std::is_same_v<T, void>);
+
+    using Const = Slice<std::add_const_t<T>>;
+
+    template <std::ranges::contiguous_range R>
+        requires std::ranges::sized_range<R> &&
+                 (std::is_lvalue_reference_v<R> ||
+                  std::ranges::borrowed_range<R>) &&
+                 std::is_convertible_v<
+                     std::remove_reference_t<std::ranges::range_reference_t<R>> (*)[],
+                     T (*)[]>
+    explicit Slice(R&& range) noexcept
+        : Slice{std::ranges::data(range),
+                static_cast<std::size_t>(std::ranges::size(range))} {}
+
+    // Unchecked: [data, data + size) must be valid. Null data is allowed
+    // for size 0 only
+    static Slice from_raw_parts(T* data, std::size_t size) noexcept {
+        return Slice{data, size};
+    }
+
+    std::size_t size() const noexcept { return _size; }
+    bool empty() const noexcept { return _size == 0; }
+
+    T* data() noexcept { return _data; }
+    std::add_const_t<T>* data() const noexcept { return _data; }
+
+    T* begin() noexcept { return _data; }
+    T* end() noexcept { return _data + _size; }
+    std::add_const_t<T>* begin() const noexcept { return _data; }
+    std::add_const_t<T>* end() const noexcept { return _data + _size; }
+
+    operator Const() const noexcept { return Const::from_raw_parts(_data, _size); }
+
+    std::span<T> as_span() noexcept { return {_data, _size}; }
+    std::span<std::add_const_t<T>> as_span() const noexcept {
+        return {_data, _size};
+    }
+
+    Option<Ref<T>> get(std::size_t i) noexcept {
+        if (i >= _size) {
+            return None;
+        }
+        return {Some, Ref<T>{_data[i]}};
+    }
+    Option<Ref<std::add_const_t<T>>> get(std::size_t i) const noexcept {
+        return Const{*this}.get(i);
+    }
+
+    Option<Slice> get(IndexRange range) noexcept {
+        if (range.first > range.last || range.last > _size) {
+            return None;
+        }
+        return {Some, Slice{_data + range.first, range.last - range.first}};
+    }
+    Option<Const> get(IndexRange range) const noexcept {
+        return Const{*this}.get(range);
+    }
+
+    Option<Ref<T>> first() noexcept { return get(0); }
+    Option<Ref<std::add_const_t<T>>> first() const noexcept { return get(0); }
+
+    Option<Ref<T>> last() noexcept {
+        return empty() ? Option<Ref<T>>{None} : get(_size - 1);
+    }
+    Option<Ref<std::add_const_t<T>>> last() const noexcept {
+        return Const{*this}.last();
+    }
+
+    // First element and the rest; None if empty
+    Option<std::pair<Ref<T>, Slice>> split_first() noexcept {
+        if (empty()) {
+            return None;
+        }
+        return {Some, Ref<T>{_data[0]}, Slice{_data + 1, _size - 1}};
+    }
+    Option<std::pair<Ref<std::add_const_t<T>>, Const>>
+    split_first() const noexcept {
+        return Const{*this}.split_first();
+    }
+
+    // Last element and everything before it; None if empty
+    Option<std::pair<Ref<T>, Slice>> split_last() noexcept {
+        if (empty()) {
+            return None;
+        }
+        return {Some, Ref<T>{_data[_size - 1]}, Slice{_data, _size - 1}};
+    }
+    Option<std::pair<Ref<std::add_const_t<T>>, Const>>
+    split_last() const noexcept {
+        return Const{*this}.split_last();
+    }
+
+    // [0, mid) and [mid, size); None if mid > size
+    Option<std::pair<Slice, Slice>> split_at(std::size_t mid) noexcept {
+        if (mid > _size) {
+            return None;
+        }
+        return {Some, Slice{_data, mid}, Slice{_data + mid, _size - mid}};
+    }
+    Option<std::pair<Const, Const>> split_at(std::size_t mid) const noexcept {
+        return Const{*this}.split_at(mid);
+    }
+
+    // i-th run of `chunk_size` elements; the last one may be shorter.
+    // None past the end or for chunk_size 0
+    Option<Slice> chunk(std::size_t i, std::size_t chunk_size) noexcept {
+        // rounding up without `_size + chunk_size - 1`, which overflows
+        if (chunk_size == 0 ||
+            i >= _size / chunk_size + (_size % chunk_size != 0)) {
+            return None;
+        }
+        const std::size_t first = i * chunk_size;
+        return {Some,
+                Slice{_data + first, std::min(chunk_size, _size - first)}};
+    }
+    Option<Const> chunk(std::size_t i, std::size_t chunk_size) const noexcept {
+        return Const{*this}.chunk(i, chunk_size);
+    }
+
+    bool ref_equals(const Slice& other) const noexcept {
+        return _data == other._data && _size == other._size;
+    }
+
+  private:
+    friend struct OptionStorage<Slice>;
+
+    Slice(T* data, std::size_t size) noexcept
+        : _data{data != nullptr ? data : dangling()}, _size{size} {}
+
+    struct RawTag {};
+
+    Slice(RawTag, T* data, std::size_t size) noexcept
+        : _data{data}, _size{size} {}
+
+    // Aligned, never dereferenced
+    static T* dangling() noexcept {
+        return reinterpret_cast<T*>(alignof(T));
+    }
+
+    T* _data;
+    std::size_t _size;
+};
+
+template <std::ranges::contiguous_range R>
+Slice(R&&)
+    -> Slice<std::remove_reference_t<std::ranges::range_reference_t<R>>>;
+
+// Null data pointer is None; null with size 1 is the niche of
+// Option<Option<>>
+template <class T>
+struct OptionStorage<Slice<T>> {
+    bool is_some() const noexcept { return _slice._data != nullptr; }
+
+    Slice<T>& unwrap_unsafe() & noexcept { return _slice; }
+    const Slice<T>& unwrap_unsafe() const& noexcept { return _slice; }
+    Slice<T>&& unwrap_unsafe() && noexcept { return std::move(_slice); }
+
+    void swap(OptionStorage& other) noexcept {
+        std::swap(_slice, other._slice);
+    }
+
+    OptionStorage(NoneTag) noexcept
+        : _slice{typename Slice<T>::RawTag{}, nullptr, 0} {}
+
+    explicit OptionStorage(NicheTag) noexcept
+        : _slice{typename Slice<T>::RawTag{}, nullptr, 1} {}
+    bool is_niche() const noexcept {
+        return _slice._data == nullptr && _slice._size == 1;
+    }
+
+    template <class... Args>
+        requires std::is_constructible_v<Slice<T>, Args...>
+    OptionStorage(SomeTag, Args&&... args) noexcept
+        : _slice(std::forward<Args>(args)...) {
+#if defined(__GNUC__)
+        // Slice data is never null: lets the compiler fold is_some()
+        if (_slice._data == nullptr) {
+            __builtin_unreachable();
+        }
+#endif
+    }
+
+  private:
+    Slice<T> _slice;
+};
+
+} // namespace better
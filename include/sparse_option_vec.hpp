@@ -0,0 +1,486 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "option.hpp"
+#include "ref.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace better {
+
+namespace detail {
+
+// Present positions of one 64K slice, roaring style.
+// Offsets within the slice are kept in whichever form is the smallest:
+// sorted array, bitmap or runs
+struct SparseChunk {
+    enum class Kind : std::uint8_t { Array, Bitmap, Runs };
+
+    static constexpr std::size_t Bits = 16;
+    static constexpr std::size_t Span = std::size_t{1} << Bits;
+    static constexpr std::size_t BitmapWords = Span / 64;
+    // Bitmap keeps number of present offsets before each block of words
+    // to answer rank queries with a few popcounts
+    static constexpr std::size_t BlockWords = 16;
+    static constexpr std::size_t BitmapBlocks = BitmapWords / BlockWords;
+    // Beyond that array is larger than bitmap
+    static constexpr std::size_t MaxArraySize = BitmapWords * 4;
+
+    SparseChunk(std::size_t key, std::size_t base) noexcept
+        : key{key}, base{base} {}
+
+    // Offsets must be appended in increasing order
+    void append(std::uint16_t low) {
+        const bool extends_run = cardinality != 0 && low == last + 1;
+        switch (kind) {
+        case Kind::Array:
+            shorts.push_back(low);
+            break;
+        case Kind::Bitmap:
+            set_bit(low);
+            break;
+        case Kind::Runs:
+            if (extends_run) {
+                shorts[shorts.size() - 2] = low;
+            } else {
+                shorts.insert(shorts.end(),
+                              {low, low, static_cast<std::uint16_t>(cardinality)});
+            }
+            break;
+        }
+        run_count += !extends_run;
+        ++cardinality;
+        last = low;
+        if (kind == Kind::Array && shorts.size() > MaxArraySize) {
+            convert(Kind::Bitmap);
+        }
+    }
+
+    // Number of present offsets before `low` if `low` is present
+    Option<std::uint32_t> rank_of(std::uint16_t low) const noexcept {
+        switch (kind) {
+        case Kind::Array: {
+            const auto it = std::lower_bound(shorts.begin(), shorts.end(), low);
+            if (it != shorts.end() && *it == low) {
+                return {Some, static_cast<std::uint32_t>(it - shorts.begin())};
+            }
+            return None;
+        }
+        case Kind::Bitmap: {
+            const std::size_t w = low / 64;
+            const std::uint64_t bit = std::uint64_t{1} << (low % 64);
+            if (!(words[w] & bit)) {
+                return None;
+            }
+            std::uint32_t rank = shorts[w / BlockWords] +
+                                 std::popcount(words[w] & (bit - 1));
+            for (std::size_t i = w - w % BlockWords; i < w; ++i) {
+                rank += std::popcount(words[i]);
+            }
+            return {Some, rank};
+        }
+        case Kind::Runs: {
+            // last run starting at or before `low`
+            std::size_t lo = 0;
+            std::size_t hi = shorts.size() / 3;
+            while (lo < hi) {
+                const std::size_t mid = (lo + hi) / 2;
+                if (shorts[3 * mid] <= low) {
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
+            }
+            if (lo == 0 || shorts[3 * (lo - 1) + 1] < low) {
+                return None;
+            }
+            const std::uint16_t* run = &shorts[3 * (lo - 1)];
+            return {Some, std::uint32_t{run[2]} + (low - run[0])};
+        }
+        }
+        return None;
+    }
+
+    // Sequential walk over present offsets. `cursor` belongs to the caller
+    // and starts at 0; returns None when the chunk is exhausted
+    Option<std::uint16_t> next(std::size_t& cursor) const noexcept {
+        switch (kind) {
+        case Kind::Array:
+            if (cursor < shorts.size()) {
+                return {Some, shorts[cursor++]};
+            }
+            return None;
+        case Kind::Bitmap:
+            // cursor is the first offset to look at
+            for (std::size_t w = cursor / 64; w < words.size(); ++w) {
+                auto bits = words[w];
+                if (w == cursor / 64) {
+                    bits &= ~std::uint64_t{0} << (cursor % 64);
+                }
+                if (bits != 0) {
+                    const std::size_t low = w * 64 + std::countr_zero(bits);
+                    cursor = low + 1;
+                    return {Some, static_cast<std::uint16_t>(low)};
+                }
+            }
+            cursor = Span;
+            return None;
+        case Kind::Runs: {
+            // cursor is run index * Span + position inside the run
+            const std::size_t run = 3 * (cursor / Span);
+            if (run >= shorts.size()) {
+                return None;
+            }
+            const std::size_t low = shorts[run] + cursor % Span;
+            cursor = low == shorts[run + 1] ? (cursor / Span + 1) * Span
+                                            : cursor + 1;
+            return {Some, static_cast<std::uint16_t>(low)};
+        }
+        }
+        return None;
+    }
+
+    // Switches to the smallest representation
+    void optimize() {
+        const std::size_t array_bytes = cardinality * sizeof(std::uint16_t);
+        const std::size_t bitmap_bytes =
+            BitmapWords * sizeof(std::uint64_t) +
+            BitmapBlocks * sizeof(std::uint16_t);
+        const std::size_t runs_bytes = run_count * 3 * sizeof(std::uint16_t);
+        if (runs_bytes < std::min(array_bytes, bitmap_bytes)) {
+            convert(Kind::Runs);
+        } else if (array_bytes <= bitmap_bytes) {
+            convert(Kind::Array);
+        } else {
+            convert(Kind::Bitmap);
+        }
+        shorts.shrink_to_fit();
+        words.shrink_to_fit();
+    }
+
+    std::size_t memory_bytes() const noexcept {
+        return sizeof(SparseChunk) + shorts.capacity() * sizeof(std::uint16_t) +
+               words.capacity() * sizeof(std::uint64_t);
+    }
+
+    // position >> Bits
+    std::size_t key;
+    // Present values in all previous chunks
+    std::size_t base;
+    std::uint32_t cardinality = 0;
+    std::uint32_t run_count = 0;
+    std::uint16_t last = 0;
+    Kind kind = Kind::Array;
+    // Array: sorted offsets.
+    // Bitmap: present offsets before each block of words.
+    // Runs: (first, last, rank of first) triples
+    std::vector<std::uint16_t> shorts;
+    // Bitmap: Span bits
+    std::vector<std::uint64_t> words;
+
+  private:
+    // Offsets come in increasing order, so blocks between the previous
+    // offset and this one get their counts here
+    void set_bit(std::uint16_t low) {
+        const std::size_t from =
+            cardinality == 0 ? 0 : last / (64 * BlockWords) + 1;
+        for (std::size_t b = from; b <= low / (64 * BlockWords); ++b) {
+            shorts[b] = static_cast<std::uint16_t>(cardinality);
+        }
+        words[low / 64] |= std::uint64_t{1} << (low % 64);
+    }
+
+    template <class F>
+    void for_each(F&& f) const {
+        switch (kind) {
+        case Kind::Array:
+            std::for_each(shorts.begin(), shorts.end(), f);
+            break;
+        case Kind::Bitmap:
+            for (std::size_t w = 0; w < words.size(); ++w) {
+                for (auto bits = words[w]; bits != 0; bits &= bits - 1) {
+                    f(static_cast<std::uint16_t>(w * 64 +
+                                                 std::countr_zero(bits)));
+                }
+            }
+            break;
+        case Kind::Runs:
+            for (std::size_t r = 0; r < shorts.size(); r += 3) {
+                for (std::uint32_t x = shorts[r]; x <= shorts[r + 1]; ++x) {
+                    f(static_cast<std::uint16_t>(x));
+                }
+            }
+            break;
+        }
+    }
+
+    void convert(Kind to) {
+        if (to == kind) {
+            return;
+        }
+        std::vector<std::uint16_t> lows;
+        lows.reserve(cardinality);
+        for_each([&](std::uint16_t low) { lows.push_back(low); });
+
+        shorts.clear();
+        words.clear();
+        kind = to;
+        switch (to) {
+        case Kind::Array:
+            shorts = std::move(lows);
+            break;
+        case Kind::Bitmap:
+            words.assign(BitmapWords, 0);
+            shorts.assign(BitmapBlocks, 0);
+            cardinality = 0;
+            for (auto low : lows) {
+                set_bit(low);
+                ++cardinality;
+                last = low;
+            }
+            break;
+        case Kind::Runs:
+            shorts.reserve(run_count * 3);
+            for (std::size_t i = 0; i < lows.size(); ++i) {
+                if (i != 0 && lows[i] == lows[i - 1] + 1) {
+                    shorts[shorts.size() - 2] = lows[i];
+                } else {
+                    shorts.insert(shorts.end(),
+                                  {lows[i], lows[i],
+                                   static_cast<std::uint16_t>(i)});
+                }
+            }
+            break;
+        }
+    }
+};
+
+} // namespace detail
+
+// Append-only sequence of Option<T> for columns where few values are
+// present. Present values are stored contiguously; positions are kept
+// in roaring-style chunks of 64K, so absent values cost (almost) nothing
+template <class T>
+struct SparseOptionVec {
+  private:
+    template <bool Const>
+    struct Iterator;
+
+  public:
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    void push(const Option<T>& value) {
+        if (value.is_some()) {
+            push_some(value.unwrap());
+        } else {
+            push_none();
+        }
+    }
+
+    void push(Option<T>&& value) {
+        if (value.is_some()) {
+            push_some(std::move(value).unwrap());
+        } else {
+            push_none();
+        }
+    }
+
+    template <class... Args>
+    void push_some(Args&&... args)
+        requires std::is_constructible_v<T, Args...>
+    {
+        const std::size_t key = _size >> detail::SparseChunk::Bits;
+        if (_chunks.empty() || _chunks.back().key != key) {
+            if (!_chunks.empty()) {
+                // previous chunk is complete
+                _chunks.back().optimize();
+            }
+            _chunks.emplace_back(key, _values.size());
+        }
+        _values.emplace_back(std::forward<Args>(args)...);
+        _chunks.back().append(static_cast<std::uint16_t>(_size));
+        ++_size;
+    }
+
+    void push_none(std::size_t count = 1) noexcept { _size += count; }
+
+    std::size_t size() const noexcept { return _size; }
+    bool empty() const noexcept { return _size == 0; }
+    std::size_t count_some() const noexcept { return _values.size(); }
+
+    // O(log n): chunk lookup plus lookup inside the chunk
+    Option<Ref<T>> get(std::size_t i) noexcept {
+        const auto pos = value_position(i);
+        if (pos.is_some()) {
+            return {Some, Ref{_values[pos.unwrap()]}};
+        }
+        return None;
+    }
+
+    Option<Ref<const T>> get(std::size_t i) const noexcept {
+        const auto pos = value_position(i);
+        if (pos.is_some()) {
+            return {Some, Ref{_values[pos.unwrap()]}};
+        }
+        return None;
+    }
+
+    // Present values in order of their positions
+    std::span<T> values() noexcept { return _values; }
+    std::span<const T> values() const noexcept { return _values; }
+
+    // Compacts the last chunk too
+    void shrink_to_fit() {
+        if (!_chunks.empty()) {
+            _chunks.back().optimize();
+        }
+        _chunks.shrink_to_fit();
+        _values.shrink_to_fit();
+    }
+
+    std::size_t memory_bytes() const noexcept {
+        std::size_t bytes = sizeof(*this) + _values.capacity() * sizeof(T) +
+                            (_chunks.capacity() - _chunks.size()) *
+                                sizeof(detail::SparseChunk);
+        for (const auto& chunk : _chunks) {
+            bytes += chunk.memory_bytes();
+        }
+        return bytes;
+    }
+
+    iterator begin() noexcept { return iterator{this, 0}; }
+    iterator end() noexcept { return iterator{this, _size}; }
+    const_iterator begin() const noexcept { return const_iterator{this, 0}; }
+    const_iterator end() const noexcept {
+        return const_iterator{this, _size};
+    }
+
+  private:
+    // Visits every position, O(1) amortized per step:
+    // keeps the next present position and walks chunks only to find it
+    template <bool Const>
+    struct Iterator {
+        using Vec =
+            std::conditional_t<Const, const SparseOptionVec, SparseOptionVec>;
+
+        using iterator_concept = std::forward_iterator_tag;
+        using value_type =
+            Option<Ref<std::conditional_t<Const, const T, T>>>;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+
+        value_type operator*() const noexcept {
+            if (_index == _next) {
+                return value_type{Some, Ref{_vec->_values[_value]}};
+            }
+            return None;
+        }
+
+        Iterator& operator++() noexcept {
+            if (_index == _next) {
+                ++_value;
+                find_next();
+            }
+            ++_index;
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            Iterator prev = *this;
+            ++*this;
+            return prev;
+        }
+
+        bool operator==(const Iterator& other) const noexcept {
+            return _index == other._index;
+        }
+
+      private:
+        friend struct SparseOptionVec;
+
+        static constexpr std::size_t NoNext = static_cast<std::size_t>(-1);
+
+        Iterator(Vec* vec, std::size_t index) noexcept
+            : _vec{vec}, _index{index} {
+            if (_index == 0) {
+                find_next();
+            }
+        }
+
+        void find_next() noexcept {
+            const auto& chunks = _vec->_chunks;
+            for (; _chunk < chunks.size(); ++_chunk, _cursor = 0) {
+                const auto low = chunks[_chunk].next(_cursor);
+                if (low.is_some()) {
+                    _next = (chunks[_chunk].key << detail::SparseChunk::Bits) +
+                            low.unwrap();
+                    return;
+                }
+            }
+            _next = NoNext;
+        }
+
+        Vec* _vec = nullptr;
+        std::size_t _index = 0;
+        std::size_t _next = NoNext;
+        std::size_t _value = 0;
+        std::size_t _chunk = 0;
+        std::size_t _cursor = 0;
+    };
+
+    Option<std::size_t> value_position(std::size_t i) const noexcept {
+        if (i >= _size) {
+            return None;
+        }
+        const std::size_t key = i >> detail::SparseChunk::Bits;
+        const auto chunk = std::lower_bound(
+            _chunks.begin(), _chunks.end(), key,
+            [](const detail::SparseChunk& c, std::size_t k) {
+                return c.key < k;
+            });
+        if (chunk == _chunks.end() || chunk->key != key) {
+            return None;
+        }
+        const auto rank = chunk->rank_of(static_cast<std::uint16_t>(i));
+        if (rank.is_some()) {
+            return {Some, chunk->base + rank.unwrap()};
+        }
+        return None;
+    }
+
+    std::vector<T> _values;
+    std::vector<detail::SparseChunk> _chunks;
+    std::size_t _size = 0;
+};
+
+} // namespace better
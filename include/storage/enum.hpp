@@ -0,0 +1,90 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include "flag.hpp"
+
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace better {
+
+// Enums may declare the largest valid enumerator:
+//
+// template <>
+// struct better::enum_max<Status> {
+//     static constexpr Status value = Status::Timeout;
+// };
+//
+// or a dedicated enumerator `_better_none` that is never used as a value.
+// Then Option<E> stores None in the value right after the valid range
+// (or in `_better_none`) and sizeof(Option<E>) == sizeof(E).
+template <class E>
+struct enum_max {};
+
+template <class E>
+concept HasBetterNoneEnumerator =
+    std::is_enum_v<E> && requires { E::_better_none; };
+
+template <class E>
+concept HasEnumMax = std::is_enum_v<E> && requires {
+    { enum_max<E>::value } -> std::convertible_to<E>;
+};
+
+namespace detail {
+
+template <class E>
+constexpr std::underlying_type_t<E> enum_none_value() {
+    using U = std::underlying_type_t<E>;
+    if constexpr (HasBetterNoneEnumerator<E>) {
+        return static_cast<U>(E::_better_none);
+    } else {
+        constexpr U max = static_cast<U>(enum_max<E>::value);
+        static_assert(max < std::numeric_limits<U>::max(),
+                      "enum_max covers the whole underlying type, "
+                      "there is no spare value for None");
+        return max + 1;
+    }
+}
+
+} // namespace detail
+
+template <class E>
+    requires HasBetterNoneEnumerator<E> || HasEnumMax<E>
+struct option_flag_traits<E> {
+    static void set_none(std::byte* bytes) noexcept {
+        std::memcpy(bytes, &none_value, sizeof(none_value));
+    }
+    static bool is_none(const std::byte* bytes) noexcept {
+        std::underlying_type_t<E> value;
+        std::memcpy(&value, bytes, sizeof(value));
+        return value == none_value;
+    }
+
+  private:
+    static constexpr std::underlying_type_t<E> none_value =
+        detail::enum_none_value<E>();
+};
+
+} // namespace better
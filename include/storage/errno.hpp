@@ -0,0 +1,150 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include "flag.hpp"
+#include "generic_result.hpp"
+
+#include "../tags.hpp"
+
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace better {
+
+namespace sys {
+
+// Error code in the kernel syscall convention: -errno in a machine word
+struct Errno {
+    // Top of the [1, 4095] range; no system uses it as a real errno
+    static constexpr int Unknown = 4095;
+
+    // Codes outside of [1, 4095] become Unknown: 0 would read back
+    // as None and anything above as an Ok value
+    explicit Errno(int code) noexcept
+        : _neg_code{-std::intptr_t{in_range(code) ? code : Unknown}} {}
+
+    // Reads current thread errno; a call that failed with errno
+    // left at 0 gives Unknown
+    static Errno last() noexcept { return Errno{errno}; }
+
+    int code() const noexcept { return static_cast<int>(-_neg_code); }
+
+    const char* message() const noexcept { return std::strerror(code()); }
+
+    bool operator==(const Errno&) const = default;
+
+  private:
+    static bool in_range(int code) noexcept {
+        return code >= 1 && code <= Unknown;
+    }
+
+    std::intptr_t _neg_code;
+};
+
+// Syscalls never return errors outside of [-4095, -1]
+inline constexpr std::uintptr_t MaxErrnoWord =
+    std::uintptr_t(-std::intptr_t{Errno::Unknown});
+
+// Values that syscalls return in one register: sizes, offsets, descriptors
+// and addresses. Valid values never fall into the [-4095, -1] range
+template <class T>
+concept SysWord = (std::is_integral_v<T> || std::is_pointer_v<T>) &&
+                  sizeof(T) == sizeof(std::uintptr_t);
+
+namespace detail {
+struct WordFactory;
+}
+
+// Syscall return value that is known to be outside of the errno range.
+// Only the wrappers in sys.hpp produce it, so Result<Word<T>, Errno>
+// can share one word with -errno. Plain Result<long, Errno> keeps
+// the generic layout: -1 is a perfectly valid Ok there
+template <SysWord T>
+struct Word {
+    T get() const noexcept { return _value; }
+    operator T() const noexcept { return _value; }
+
+    bool operator==(const Word&) const = default;
+
+  private:
+    friend struct detail::WordFactory;
+
+    explicit Word(T value) noexcept : _value{value} {}
+
+    T _value;
+};
+
+} // namespace sys
+
+// Errno is never 0, so zero word is a free None.
+// It makes Result<Void, sys::Errno> and Option<sys::Errno> one word
+template <>
+struct option_flag_traits<sys::Errno> {
+    static void set_none(std::byte* bytes) noexcept {
+        std::memset(bytes, 0, sizeof(sys::Errno));
+    }
+    static bool is_none(const std::byte* bytes) noexcept {
+        std::intptr_t word;
+        std::memcpy(&word, bytes, sizeof(word));
+        return word == 0;
+    }
+};
+
+// Value or -errno in one machine word, exactly as the kernel returns it
+template <class T>
+struct ResultStorage<sys::Word<T>, sys::Errno> {
+    bool is_ok() const noexcept {
+        return std::bit_cast<std::uintptr_t>(_word) < sys::MaxErrnoWord;
+    }
+
+    void swap(ResultStorage& other) noexcept {
+        std::swap(this->_word, other._word);
+    }
+
+    sys::Word<T>& unwrap_unsafe() & noexcept { return _word.value; }
+    const sys::Word<T>& unwrap_unsafe() const& noexcept { return _word.value; }
+
+    sys::Errno& unwrap_err_unsafe() & noexcept { return _word.err; }
+    const sys::Errno& unwrap_err_unsafe() const& noexcept { return _word.err; }
+
+    ResultStorage(OkTag, sys::Word<T> value) noexcept : _word{.value = value} {}
+
+    template <class... Args>
+    ResultStorage(ErrTag, Args&&... args) noexcept
+        requires std::is_constructible_v<sys::Errno, Args...>
+        : _word{.err = sys::Errno(std::forward<Args>(args)...)} {}
+
+  private:
+    union Word {
+        sys::Word<T> value;
+        sys::Errno err;
+    } _word;
+
+    static_assert(sizeof(Word) == sizeof(std::uintptr_t));
+};
+
+} // namespace better
@@ -0,0 +1,218 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include "generic_option.hpp"
+#include "raw.hpp"
+
+#include "../tags.hpp"
+
+#include <concepts>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace better {
+
+// Customization point to keep None flag inside of T itself
+// (in padding, reserved field, impossible value, etc.)
+// Then sizeof(Option<T>) == sizeof(T).
+//
+// template <>
+// struct better::option_flag_traits<MyType> {
+//     // Mark storage as None. There is no live T object in `bytes`
+//     static void set_none(std::byte* bytes) noexcept;
+//     // Must return false for every valid T object
+//     static bool is_none(const std::byte* bytes) noexcept;
+// };
+template <class T>
+struct option_flag_traits {};
+
+template <class T>
+concept HasOptionFlagTraits =
+    requires(std::byte* bytes, const std::byte* const_bytes) {
+        { option_flag_traits<T>::set_none(bytes) } noexcept;
+        {
+            option_flag_traits<T>::is_none(const_bytes)
+        } noexcept -> std::same_as<bool>;
+    };
+
+// bool object is either 0 or 1, so 2 marks None
+template <>
+struct option_flag_traits<bool> {
+    static_assert(sizeof(bool) == 1);
+
+    static void set_none(std::byte* bytes) noexcept { *bytes = std::byte{2}; }
+    static bool is_none(const std::byte* bytes) noexcept {
+        return *bytes == std::byte{2};
+    }
+};
+
+template <class T>
+    requires HasOptionFlagTraits<T>
+struct OptionStorage<T> : private RawStorage<T> {
+  private:
+    using Traits = option_flag_traits<T>;
+
+  public:
+    bool is_some() const noexcept { return !Traits::is_none(bytes()); }
+
+    void swap(OptionStorage<T>& other) noexcept(
+        std::is_trivially_move_constructible_v<T> ||
+        std::is_nothrow_move_constructible_v<T>) {
+        if constexpr (std::is_trivially_move_constructible_v<T>) {
+            std::swap(this->as_storage(), other.as_storage());
+            return;
+        } else {
+            const bool this_some = this->is_some();
+            const bool other_some = other.is_some();
+            if (other_some && this_some) {
+                std::swap(this->unwrap_unsafe(), other.unwrap_unsafe());
+                return;
+            }
+            if (other_some) {
+                new (this)
+                    OptionStorage{Some, std::move(other).unwrap_unsafe()};
+                other.reset();
+                return;
+            }
+            if (this_some) {
+                new (&other)
+                    OptionStorage{Some, std::move(this->unwrap_unsafe())};
+                this->reset();
+                return;
+            }
+        }
+        // both None, do nothing
+    }
+
+    T& unwrap_unsafe() & noexcept { return *this->get_raw(); }
+    T&& unwrap_unsafe() && noexcept { return std::move(*this->get_raw()); }
+    const T& unwrap_unsafe() const& noexcept { return *this->get_raw(); }
+
+    OptionStorage(NoneTag) noexcept { set_none(); }
+
+    template <class... Args>
+    OptionStorage(SomeTag, Args&&... args) noexcept(
+        std::is_nothrow_constructible_v<T, Args...>)
+        requires std::is_constructible_v<T, Args...>
+        : RawStorage<T>{InitializeTag{}, std::forward<Args>(args)...} {}
+
+    // -------- Copy constructors -------
+    OptionStorage(const OptionStorage&) noexcept
+        requires(std::is_trivially_copy_constructible_v<T>)
+    = default;
+
+    OptionStorage(const OptionStorage& other) noexcept(
+        std::is_nothrow_copy_constructible_v<T>)
+        requires(!std::is_trivially_copy_constructible_v<T>)
+    {
+        if (other.is_some()) {
+            new (this) OptionStorage{Some, other.unwrap_unsafe()};
+        } else {
+            set_none();
+        }
+    }
+
+    // -------- Move constructors -------
+
+    OptionStorage(OptionStorage&& other) noexcept
+        requires(std::is_trivially_move_constructible_v<T>)
+    = default;
+
+    OptionStorage(OptionStorage&& other) noexcept(
+        std::is_nothrow_move_constructible_v<T>)
+        requires(!std::is_trivially_move_constructible_v<T>)
+    {
+        if (other.is_some()) {
+            new (this) OptionStorage{Some, std::move(other).unwrap_unsafe()};
+        } else {
+            set_none();
+        }
+    }
+
+    // -------- Copy assignment -------
+
+    OptionStorage& operator=(const OptionStorage&) noexcept
+        requires(std::is_trivially_copy_assignable_v<T>)
+    = default;
+
+    OptionStorage& operator=(const OptionStorage& other) noexcept(
+        std::is_nothrow_copy_constructible_v<T> &&
+        noexcept(this->swap(std::declval<OptionStorage&>())))
+        requires(!std::is_trivially_copy_assignable_v<T>)
+    {
+        OptionStorage tmp(other);
+        this->swap(tmp);
+        return *this;
+    }
+
+    // -------- Move assignment -------
+
+    OptionStorage& operator=(OptionStorage&& other) noexcept
+        requires(std::is_trivially_move_assignable_v<T>)
+    = default;
+
+    OptionStorage& operator=(OptionStorage&& other) noexcept(
+        std::is_nothrow_move_constructible_v<T> &&
+        noexcept(this->swap(std::declval<OptionStorage&>())))
+        requires(!std::is_trivially_move_assignable_v<T>)
+    {
+        OptionStorage tmp(std::move(other));
+        this->swap(tmp);
+        return *this;
+    }
+
+    // ------ Destructors ------
+    ~OptionStorage()
+        requires(std::is_trivially_destructible_v<T>)
+    = default;
+
+    ~OptionStorage() noexcept(std::is_nothrow_destructible_v<T>)
+        requires(!std::is_trivially_destructible_v<T>)
+    {
+        if (is_some()) {
+            this->get_raw()->~T();
+        }
+    }
+    // -----------------------
+  private:
+    RawStorage<T>& as_storage() & { return *this; }
+
+    const std::byte* bytes() const noexcept {
+        return reinterpret_cast<const std::byte*>(this->get_bytes());
+    }
+
+    void set_none() noexcept {
+        Traits::set_none(reinterpret_cast<std::byte*>(this->get_bytes()));
+    }
+
+    void reset() noexcept(std::is_nothrow_destructible_v<T>) {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            if (is_some()) {
+                this->get_raw()->~T();
+            }
+        }
+        set_none();
+    }
+};
+
+} // namespace better
@@ -54,27 +54,31 @@ concept OptionStorageImpl =
 template <class T>
 struct OptionStorage : private RawStorage<T> {
   public:
-    bool is_some() const noexcept { return _initialized; }
+    bool is_some() const noexcept { return _state == State::Some; }
+
+    // Spare state for the enclosing Option (Option<Option<T>>)
+    explicit OptionStorage(NicheTag) noexcept : _state{State::Niche} {}
+    bool is_niche() const noexcept { return _state == State::Niche; }
 
     void swap(OptionStorage<T>& other) noexcept(
         std::is_trivially_move_constructible_v<T> ||
         std::is_nothrow_move_constructible_v<T>) {
         if constexpr (std::is_trivially_move_constructible_v<T>) {
             std::swap(this->as_storage(), other.as_storage());
-            std::swap(this->_initialized, other._initialized);
+            std::swap(this->_state, other._state);
             return;
         } else {
-            if (other._initialized && this->_initialized) {
+            if (other.is_some() && this->is_some()) {
                 std::swap(this->unwrap_unsafe(), other.unwrap_unsafe());
                 return;
             }
-            if (other._initialized) {
+            if (other.is_some()) {
                 new (this)
                     OptionStorage{Some, std::move(other).unwrap_unsafe()};
                 other.reset();
                 return;
             }
-            if (this->_initialized) {
+            if (this->is_some()) {
                 new (&other)
                     OptionStorage{Some, std::move(this->unwrap_unsafe())};
                 this->reset();
@@ -95,7 +99,7 @@ struct OptionStorage : private RawStorage<T> {
         std::is_nothrow_constructible_v<T, Args...>)
         requires std::is_constructible_v<T, Args...>
         : RawStorage<T>{InitializeTag{}, std::forward<Args>(args)...},
-          _initialized{true} {}
+          _state{State::Some} {}
 
     // -------- Copy constructors -------
     OptionStorage(const OptionStorage&) noexcept
@@ -181,14 +185,16 @@ struct OptionStorage : private RawStorage<T> {
 
     void reset() noexcept(std::is_nothrow_destructible_v<T>) {
         if constexpr (!std::is_trivially_destructible_v<T>) {
-            if (_initialized) {
+            if (is_some()) {
                 this->get_raw()->~T();
             }
         }
-        _initialized = false;
+        _state = State::None;
     }
 
-    bool _initialized = false;
+    enum class State : unsigned char { None, Some, Niche };
+
+    State _state = State::None;
 };
 
 } // namespace better
\ No newline at end of file
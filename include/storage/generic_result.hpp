@@ -20,11 +20,13 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 #pragma once
 
+#include "flag.hpp"
 #include "generic_option.hpp"
 #include "raw.hpp"
 
 #include "../ref.hpp"
 #include "../tags.hpp"
+#include "../void.hpp"
 
 #include <concepts>
 #include <type_traits>
@@ -86,7 +88,7 @@ struct ResultStorage : protected OptionStorage<T>, protected RawError<E> {
         }
 
         new (error_dst->as_err_storage().get_bytes())
-            E{std::move(*error_src->unwrap_err_unsafe())};
+            E{std::move(error_src->unwrap_err_unsafe())};
         error_src->unwrap_err_unsafe().~E();
     }
 
@@ -114,15 +116,28 @@ struct ResultStorage : protected OptionStorage<T>, protected RawError<E> {
         new (this->as_err_storage().get_bytes()) E{std::forward<Args>(args)...};
     }
 
+    // Spare state for the enclosing Option (Option<Result<T, E>>)
+    explicit ResultStorage(NicheTag niche) noexcept
+        requires std::is_constructible_v<OptionStorage<T>, NicheTag>
+        : OptionStorage<T>{niche} {}
+    bool is_niche() const noexcept
+        requires std::is_constructible_v<OptionStorage<T>, NicheTag>
+    {
+        return OptionStorage<T>::is_niche();
+    }
+
     // -------- Copy constructors -------
     ResultStorage(const ResultStorage&) noexcept
-        requires(std::is_trivially_copy_constructible_v<T>)
+        requires(std::is_trivially_copy_constructible_v<T> &&
+                 std::is_trivially_copy_constructible_v<E>)
     = default;
 
     ResultStorage(const ResultStorage& other) noexcept(
-        std::is_nothrow_copy_constructible_v<T>)
-        requires(!std::is_trivially_copy_constructible_v<T>)
-    {
+        std::is_nothrow_copy_constructible_v<T> &&
+        std::is_nothrow_copy_constructible_v<E>)
+        requires(!std::is_trivially_copy_constructible_v<T> ||
+                 !std::is_trivially_copy_constructible_v<E>)
+        : OptionStorage<T>{None} {
         if (other.is_ok()) {
             new (this) ResultStorage{Ok, other.unwrap_unsafe()};
         } else {
@@ -133,14 +148,17 @@ struct ResultStorage : protected OptionStorage<T>, protected RawError<E> {
     // -------- Move constructors -------
 
     ResultStorage(ResultStorage&& other) noexcept
-        requires(std::is_trivially_move_constructible_v<T>)
+        requires(std::is_trivially_move_constructible_v<T> &&
+                 std::is_trivially_move_constructible_v<E>)
     = default;
 
     // moves and resets other storage!
     ResultStorage(ResultStorage&& other) noexcept(
-        std::is_nothrow_move_constructible_v<T>)
-        requires(!std::is_trivially_move_constructible_v<T>)
-    {
+        std::is_nothrow_move_constructible_v<T> &&
+        std::is_nothrow_move_constructible_v<E>)
+        requires(!std::is_trivially_move_constructible_v<T> ||
+                 !std::is_trivially_move_constructible_v<E>)
+        : OptionStorage<T>{None} {
         if (other.is_ok()) {
             new (this) ResultStorage{Ok, std::move(other).unwrap_unsafe()};
         } else {
@@ -151,11 +169,13 @@ struct ResultStorage : protected OptionStorage<T>, protected RawError<E> {
     // -------- Copy assignment -------
 
     ResultStorage& operator=(const ResultStorage&) noexcept
-        requires(std::is_trivially_copy_assignable_v<T>)
+        requires(std::is_trivially_copy_assignable_v<T> &&
+                 std::is_trivially_copy_assignable_v<E>)
     = default;
 
     ResultStorage& operator=(const ResultStorage& other)
-        requires(!std::is_trivially_copy_assignable_v<T>)
+        requires(!std::is_trivially_copy_assignable_v<T> ||
+                 !std::is_trivially_copy_assignable_v<E>)
     {
         ResultStorage tmp(other);
         this->swap(tmp);
@@ -165,12 +185,14 @@ struct ResultStorage : protected OptionStorage<T>, protected RawError<E> {
     // -------- Move assignment -------
 
     ResultStorage& operator=(ResultStorage&& other) noexcept
-        requires(std::is_trivially_move_assignable_v<T>)
+        requires(std::is_trivially_move_assignable_v<T> &&
+                 std::is_trivially_move_assignable_v<E>)
     = default;
 
     // moves and resets other storage!
     ResultStorage& operator=(ResultStorage&& other)
-        requires(!std::is_trivially_move_assignable_v<T>)
+        requires(!std::is_trivially_move_assignable_v<T> ||
+                 !std::is_trivially_move_assignable_v<E>)
     {
         ResultStorage tmp(std::move(other));
         this->swap(tmp);
@@ -232,7 +254,7 @@ struct ResultStorage<T, T> : private MayBeWrapped<T> {
 
     void swap(ResultStorage& other) noexcept {
         std::swap(this->_is_ok, other._is_ok);
-        std::swap(this->as_inner(), other.as_inner);
+        std::swap(this->as_inner(), other.as_inner());
     }
 
     T& unwrap_unsafe() & noexcept { return as_inner(); }
@@ -253,4 +275,254 @@ struct ResultStorage<T, T> : private MayBeWrapped<T> {
     bool _is_ok;
 };
 
-} // namespace better
\ No newline at end of file
+// Result<T, Void> has exactly the same layout as Option<T>
+// (niches included): Err is None
+template <class T>
+    requires(!std::is_same_v<T, Void>)
+struct ResultStorage<T, Void> : protected OptionStorage<T> {
+    bool is_ok() const noexcept { return this->is_some(); }
+    using OptionStorage<T>::unwrap_unsafe;
+
+    void swap(ResultStorage& other) noexcept(
+        noexcept(std::declval<OptionStorage<T>&>().swap(
+            std::declval<OptionStorage<T>&>()))) {
+        OptionStorage<T>::swap(other);
+    }
+
+    Void& unwrap_err_unsafe() & noexcept { return err_value; }
+    const Void& unwrap_err_unsafe() const& noexcept { return err_value; }
+
+    template <class... Args>
+    ResultStorage(OkTag, Args&&... args) noexcept(
+        std::is_nothrow_constructible_v<T, Args...>)
+        requires std::is_constructible_v<T, Args...>
+        : OptionStorage<T>{Some, std::forward<Args>(args)...} {}
+
+    template <class... Args>
+    ResultStorage(ErrTag, Args&&...) noexcept : OptionStorage<T>{None} {}
+
+    explicit ResultStorage(NicheTag niche) noexcept
+        requires std::is_constructible_v<OptionStorage<T>, NicheTag>
+        : OptionStorage<T>{niche} {}
+    bool is_niche() const noexcept
+        requires std::is_constructible_v<OptionStorage<T>, NicheTag>
+    {
+        return OptionStorage<T>::is_niche();
+    }
+
+    explicit ResultStorage(OptionStorage<T>&& storage) noexcept(
+        std::is_nothrow_move_constructible_v<OptionStorage<T>>)
+        : OptionStorage<T>{std::move(storage)} {}
+
+    explicit ResultStorage(const OptionStorage<T>& storage) noexcept(
+        std::is_nothrow_copy_constructible_v<OptionStorage<T>>)
+        : OptionStorage<T>{storage} {}
+
+    OptionStorage<T>& as_option_storage() & noexcept { return *this; }
+    const OptionStorage<T>& as_option_storage() const& noexcept {
+        return *this;
+    }
+
+  private:
+    // Void has no state, so every Err may share it
+    static inline Void err_value{};
+};
+
+// Result<Void, E> has exactly the same layout as Option<E>
+// (niches included): Ok is None
+template <class E>
+    requires(!std::is_same_v<E, Void>)
+struct ResultStorage<Void, E> : protected OptionStorage<E> {
+    bool is_ok() const noexcept { return !this->is_some(); }
+
+    void swap(ResultStorage& other) noexcept(
+        noexcept(std::declval<OptionStorage<E>&>().swap(
+            std::declval<OptionStorage<E>&>()))) {
+        OptionStorage<E>::swap(other);
+    }
+
+    Void& unwrap_unsafe() & noexcept { return ok_value; }
+    const Void& unwrap_unsafe() const& noexcept { return ok_value; }
+
+    // decltype(auto) to keep const propagation of OptionStorage<Ref<T>>
+    decltype(auto) unwrap_err_unsafe() & noexcept {
+        return OptionStorage<E>::unwrap_unsafe();
+    }
+    decltype(auto) unwrap_err_unsafe() && noexcept {
+        return std::move(*this).OptionStorage<E>::unwrap_unsafe();
+    }
+    decltype(auto) unwrap_err_unsafe() const& noexcept {
+        return OptionStorage<E>::unwrap_unsafe();
+    }
+
+    template <class... Args>
+    ResultStorage(OkTag, Args&&...) noexcept : OptionStorage<E>{None} {}
+
+    template <class... Args>
+    ResultStorage(ErrTag, Args&&... args) noexcept(
+        std::is_nothrow_constructible_v<E, Args...>)
+        requires std::is_constructible_v<E, Args...>
+        : OptionStorage<E>{Some, std::forward<Args>(args)...} {}
+
+    explicit ResultStorage(NicheTag niche) noexcept
+        requires std::is_constructible_v<OptionStorage<E>, NicheTag>
+        : OptionStorage<E>{niche} {}
+    bool is_niche() const noexcept
+        requires std::is_constructible_v<OptionStorage<E>, NicheTag>
+    {
+        return OptionStorage<E>::is_niche();
+    }
+
+    explicit ResultStorage(OptionStorage<E>&& storage) noexcept(
+        std::is_nothrow_move_constructible_v<OptionStorage<E>>)
+        : OptionStorage<E>{std::move(storage)} {}
+
+    explicit ResultStorage(const OptionStorage<E>& storage) noexcept(
+        std::is_nothrow_copy_constructible_v<OptionStorage<E>>)
+        : OptionStorage<E>{storage} {}
+
+    OptionStorage<E>& as_option_storage() & noexcept { return *this; }
+    const OptionStorage<E>& as_option_storage() const& noexcept {
+        return *this;
+    }
+
+  private:
+    static inline Void ok_value{};
+};
+
+// Error type keeps a spare value (see option_flag_traits),
+// so Ok is stored as "no error" without a separate flag
+template <class T, class E>
+    requires(HasOptionFlagTraits<E> && !HasOptionFlagTraits<T> &&
+             !std::is_same_v<T, Void> && !std::is_same_v<T, E>)
+struct ResultStorage<T, E> {
+    bool is_ok() const noexcept { return !_err.is_some(); }
+
+    void swap(ResultStorage& other) noexcept(
+        std::is_nothrow_move_constructible_v<T> &&
+        std::is_nothrow_swappable_v<T> &&
+        std::is_nothrow_move_constructible_v<E>) {
+        const bool this_ok = this->is_ok();
+        const bool other_ok = other.is_ok();
+        if (this_ok && other_ok) {
+            std::swap(this->unwrap_unsafe(), other.unwrap_unsafe());
+            return;
+        }
+        if (!this_ok && !other_ok) {
+            _err.swap(other._err);
+            return;
+        }
+        ResultStorage& ok_side = this_ok ? *this : other;
+        ResultStorage& err_side = this_ok ? other : *this;
+
+        new (err_side._ok.get_bytes()) T{std::move(ok_side.unwrap_unsafe())};
+        ok_side.unwrap_unsafe().~T();
+        ok_side._err.swap(err_side._err);
+    }
+
+    T& unwrap_unsafe() & noexcept { return *_ok.get_raw(); }
+    T&& unwrap_unsafe() && noexcept { return std::move(*_ok.get_raw()); }
+    const T& unwrap_unsafe() const& noexcept { return *_ok.get_raw(); }
+
+    E& unwrap_err_unsafe() & noexcept { return _err.unwrap_unsafe(); }
+    E&& unwrap_err_unsafe() && noexcept {
+        return std::move(_err).unwrap_unsafe();
+    }
+    const E& unwrap_err_unsafe() const& noexcept {
+        return _err.unwrap_unsafe();
+    }
+
+    template <class... Args>
+    ResultStorage(OkTag, Args&&... args) noexcept(
+        std::is_nothrow_constructible_v<T, Args...>)
+        requires std::is_constructible_v<T, Args...>
+        : _ok{InitializeTag{}, std::forward<Args>(args)...}, _err{None} {}
+
+    template <class... Args>
+    ResultStorage(ErrTag, Args&&... args) noexcept(
+        std::is_nothrow_constructible_v<E, Args...>)
+        requires std::is_constructible_v<E, Args...>
+        : _err{Some, std::forward<Args>(args)...} {}
+
+    // -------- Copy constructors -------
+    ResultStorage(const ResultStorage&) noexcept
+        requires(std::is_trivially_copy_constructible_v<T> &&
+                 std::is_trivially_copy_constructible_v<E>)
+    = default;
+
+    ResultStorage(const ResultStorage& other) noexcept(
+        std::is_nothrow_copy_constructible_v<T> &&
+        std::is_nothrow_copy_constructible_v<E>)
+        requires(!std::is_trivially_copy_constructible_v<T> ||
+                 !std::is_trivially_copy_constructible_v<E>)
+        : _err{other._err} {
+        if (other.is_ok()) {
+            new (_ok.get_bytes()) T{other.unwrap_unsafe()};
+        }
+    }
+
+    // -------- Move constructors -------
+    ResultStorage(ResultStorage&&) noexcept
+        requires(std::is_trivially_move_constructible_v<T> &&
+                 std::is_trivially_move_constructible_v<E>)
+    = default;
+
+    ResultStorage(ResultStorage&& other) noexcept(
+        std::is_nothrow_move_constructible_v<T> &&
+        std::is_nothrow_move_constructible_v<E>)
+        requires(!std::is_trivially_move_constructible_v<T> ||
+                 !std::is_trivially_move_constructible_v<E>)
+        : _err{std::move(other._err)} {
+        if (other.is_ok()) {
+            new (_ok.get_bytes()) T{std::move(other).unwrap_unsafe()};
+        }
+    }
+
+    // -------- Copy assignment -------
+    ResultStorage& operator=(const ResultStorage&) noexcept
+        requires(std::is_trivially_copy_assignable_v<T> &&
+                 std::is_trivially_copy_assignable_v<E>)
+    = default;
+
+    ResultStorage& operator=(const ResultStorage& other)
+        requires(!std::is_trivially_copy_assignable_v<T> ||
+                 !std::is_trivially_copy_assignable_v<E>)
+    {
+        ResultStorage tmp(other);
+        this->swap(tmp);
+        return *this;
+    }
+
+    // -------- Move assignment -------
+    ResultStorage& operator=(ResultStorage&&) noexcept
+        requires(std::is_trivially_move_assignable_v<T> &&
+                 std::is_trivially_move_assignable_v<E>)
+    = default;
+
+    ResultStorage& operator=(ResultStorage&& other)
+        requires(!std::is_trivially_move_assignable_v<T> ||
+                 !std::is_trivially_move_assignable_v<E>)
+    {
+        ResultStorage tmp(std::move(other));
+        this->swap(tmp);
+        return *this;
+    }
+
+    // ------ Destructors ------
+    ~ResultStorage()
+        requires(std::is_trivially_destructible_v<T>)
+    = default;
+
+    ~ResultStorage() {
+        if (this->is_ok()) {
+            this->unwrap_unsafe().~T();
+        }
+    }
+    // -----------------------
+
+  private:
+    RawStorage<T> _ok;
+    OptionStorage<E> _err;
+};
+
+} // namespace better
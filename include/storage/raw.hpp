@@ -30,6 +30,10 @@ namespace better {
 
 struct InitializeTag {}; 
 
+// Puts storage into spare "niche" state that is never observable by users.
+// Enclosing Option uses it to mark None instead of adding one more flag
+struct NicheTag {};
+
 template <class T>
 struct RawStorage {
     alignas(T) std::byte data[sizeof(T)];
@@ -42,6 +46,9 @@ struct RawStorage {
     }
 
     char* get_bytes() noexcept { return reinterpret_cast<char*>(data); }
+    const char* get_bytes() const noexcept {
+        return reinterpret_cast<const char*>(data);
+    }
 
     T* get_raw() noexcept {
         return std::launder(reinterpret_cast<T*>(data));
@@ -55,6 +62,9 @@ template<class T>
 requires std::is_trivial_v<T> && std::is_empty_v<T>
 struct RawStorage<T>: private T {
     char* get_bytes() noexcept { return reinterpret_cast<char*>(this); }
+    const char* get_bytes() const noexcept {
+        return reinterpret_cast<const char*>(this);
+    }
 
     T* get_raw() noexcept {
         return this;
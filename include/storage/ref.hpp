@@ -22,6 +22,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "generic_option.hpp"
 
+#include <cstdint>
+
 namespace better {
 
 template <class T>
@@ -45,8 +47,22 @@ struct OptionStorage<Ref<T>> {
 
     OptionStorage(NoneTag) noexcept
         : OptionStorage(RawStorage{.raw = nullptr}) {}
+
+    // No object lives at address 1, so it is a spare state
+    // for the enclosing Option (Option<Option<Ref<T>>>)
+    explicit OptionStorage(NicheTag) noexcept
+        : OptionStorage(RawStorage{.raw = niche_ptr()}) {}
+    bool is_niche() const noexcept { return storage.raw == niche_ptr(); }
     OptionStorage(SomeTag, Ref<T> ref) noexcept
-        : OptionStorage(RawStorage{ref}) {}
+        : OptionStorage(RawStorage{ref}) {
+#if defined(__GNUC__)
+        // Ref is never null: lets the compiler fold is_some() checks
+        // right after construction
+        if (storage.raw == nullptr) {
+            __builtin_unreachable();
+        }
+#endif
+    }
 
     // Explicitly delete constructors from Raw references
     // Clients must explicitly Use Ref to avoid confusion
@@ -63,5 +79,9 @@ struct OptionStorage<Ref<T>> {
     explicit OptionStorage(RawStorage raw) noexcept : storage{raw} {
         static_assert(sizeof(RawStorage) == sizeof(T*));
     }
+
+    static T* niche_ptr() noexcept {
+        return reinterpret_cast<T*>(std::uintptr_t{1});
+    }
 };
 } // namespace better
@@ -0,0 +1,136 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "option.hpp"
+#include "result.hpp"
+#include "void.hpp"
+
+#include "storage/errno.hpp"
+
+#include <cstddef>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace better::sys {
+
+// Thin POSIX wrappers. Every Result here is one machine word:
+// value or -errno, as the raw syscall returns it.
+// Descriptors are returned as ssize_t to fit into the same word.
+// Word<T> converts to T implicitly, use get() where a cast is needed.
+
+namespace detail {
+
+template <class T>
+struct SysValue {
+    using type = T;
+};
+
+template <SysWord T>
+struct SysValue<T> {
+    using type = Word<T>;
+};
+
+struct WordFactory {
+    template <SysWord T>
+    static Word<T> make(T value) noexcept {
+        return Word<T>{value};
+    }
+};
+
+} // namespace detail
+
+template <class T>
+using SysResult = Result<typename detail::SysValue<T>::type, Errno>;
+
+static_assert(sizeof(SysResult<std::size_t>) == sizeof(std::size_t));
+static_assert(sizeof(SysResult<void*>) == sizeof(void*));
+static_assert(sizeof(SysResult<Void>) == sizeof(void*));
+
+namespace detail {
+
+template <class T, class Ret>
+SysResult<T> from_ret(Ret ret) noexcept {
+    if (ret >= 0) {
+        return SysResult<T>{Ok, WordFactory::make(static_cast<T>(ret))};
+    } else {
+        return SysResult<T>{Err, Errno::last()};
+    }
+}
+
+inline SysResult<Void> from_status(int ret) noexcept {
+    if (ret == 0) {
+        return SysResult<Void>{Ok};
+    } else {
+        return SysResult<Void>{Err, Errno::last()};
+    }
+}
+
+} // namespace detail
+
+inline SysResult<std::size_t> read(int fd, void* buf,
+                                   std::size_t count) noexcept {
+    return detail::from_ret<std::size_t>(::read(fd, buf, count));
+}
+
+inline SysResult<std::size_t> write(int fd, const void* buf,
+                                    std::size_t count) noexcept {
+    return detail::from_ret<std::size_t>(::write(fd, buf, count));
+}
+
+inline SysResult<std::size_t> pread(int fd, void* buf, std::size_t count,
+                                    off_t offset) noexcept {
+    return detail::from_ret<std::size_t>(::pread(fd, buf, count, offset));
+}
+
+inline SysResult<std::size_t> pwrite(int fd, const void* buf,
+                                     std::size_t count, off_t offset) noexcept {
+    return detail::from_ret<std::size_t>(::pwrite(fd, buf, count, offset));
+}
+
+inline SysResult<ssize_t> open(const char* path, int flags,
+                               mode_t mode = 0) noexcept {
+    return detail::from_ret<ssize_t>(::open(path, flags, mode));
+}
+
+inline SysResult<Void> close(int fd) noexcept {
+    return detail::from_status(::close(fd));
+}
+
+inline SysResult<void*> mmap(void* addr, std::size_t length, int prot,
+                             int flags, int fd, off_t offset) noexcept {
+    void* ret = ::mmap(addr, length, prot, flags, fd, offset);
+    if (ret != MAP_FAILED) {
+        return SysResult<void*>{Ok, detail::WordFactory::make(ret)};
+    } else {
+        return SysResult<void*>{Err, Errno::last()};
+    }
+}
+
+inline SysResult<Void> munmap(void* addr, std::size_t length) noexcept {
+    return detail::from_status(::munmap(addr, length));
+}
+
+} // namespace better::sys
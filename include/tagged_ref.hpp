@@ -0,0 +1,164 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "option.hpp"
+#include "ref.hpp"
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace better {
+
+// Ref with `Bits` user tag bits packed into the low bits of the pointer,
+// which alignment of T keeps zero. get() costs one extra AND.
+// Trivially copyable: std::atomic<TaggedRef> updates pointer and tag
+// together with a single CAS
+template <class T, unsigned Bits>
+struct TaggedRef final {
+    static_assert(!std::is_reference_v<T>);
+    static_assert(!std::is_same_v<T, void>);
+    static_assert(Bits < 8);
+
+    using Const = TaggedRef<std::add_const_t<T>, Bits>;
+
+    static constexpr std::uintptr_t TagMask = (std::uintptr_t{1} << Bits) - 1;
+
+    // Tag bits above `Bits` are dropped
+    explicit TaggedRef(T& x, std::uintptr_t tag = 0) noexcept
+        : _word{reinterpret_cast<std::uintptr_t>(&x) | (tag & TagMask)} {
+        // here, not at class level: intrusive nodes link to incomplete T
+        static_assert((std::uintptr_t{1} << Bits) <= alignof(T),
+                      "alignment of T doesn't leave that many spare bits");
+    }
+    // Rvalues are banned!
+    TaggedRef(T&&, std::uintptr_t = 0) = delete;
+
+    T& get() noexcept { return *ptr(); }
+    // Propagate const for safety!
+    std::add_const_t<T>& get() const noexcept { return *ptr(); }
+
+    decltype(auto) operator*() noexcept { return get(); }
+    decltype(auto) operator*() const noexcept { return get(); }
+
+    T* operator->() noexcept { return ptr(); }
+    std::add_const_t<T>* operator->() const noexcept { return ptr(); }
+
+    operator T&() noexcept { return get(); }
+    operator std::add_const_t<T>&() const noexcept { return get(); }
+
+    operator Const() const noexcept { return Const{get(), tag()}; }
+
+    operator std::remove_const_t<T>() const = delete;
+    operator std::remove_const_t<T>() = delete;
+
+    std::uintptr_t tag() const noexcept { return _word & TagMask; }
+
+    void set_tag(std::uintptr_t tag) noexcept {
+        _word = (_word & ~TagMask) | (tag & TagMask);
+    }
+
+    // Same target, another tag
+    TaggedRef with_tag(std::uintptr_t tag) const noexcept {
+        TaggedRef copy = *this;
+        copy.set_tag(tag);
+        return copy;
+    }
+
+    // Single tag bit, for flags like color or deletion mark.
+    // The bit is a template argument so that it is checked against `Bits`
+    template <unsigned Bit>
+        requires(Bit < Bits)
+    bool test() const noexcept {
+        return (_word >> Bit) & 1;
+    }
+
+    template <unsigned Bit>
+        requires(Bit < Bits)
+    void set(bool value) noexcept {
+        set_tag(value ? tag() | (std::uintptr_t{1} << Bit)
+                      : tag() & ~(std::uintptr_t{1} << Bit));
+    }
+
+    Ref<T> ref() noexcept { return Ref<T>{get()}; }
+    Ref<std::add_const_t<T>> ref() const noexcept {
+        return Ref<std::add_const_t<T>>{get()};
+    }
+
+    // Same target, tags are not compared
+    bool ref_equals(const TaggedRef& other) const noexcept {
+        return ptr() == other.ptr();
+    }
+
+    // Same target and same tag
+    bool operator==(const TaggedRef&) const noexcept = default;
+
+  private:
+    friend struct OptionStorage<TaggedRef>;
+
+    struct RawTag {};
+
+    TaggedRef(RawTag, std::uintptr_t word) noexcept : _word{word} {}
+
+    T* ptr() const noexcept { return reinterpret_cast<T*>(_word & ~TagMask); }
+
+    std::uintptr_t _word;
+};
+
+// Word 0 (null pointer, no tags) is None, word 1 is the niche of
+// Option<Option<>>. Real references never have a null pointer part,
+// so Option costs nothing and still carries all tag bits
+template <class T, unsigned Bits>
+struct OptionStorage<TaggedRef<T, Bits>> {
+    using Handle = TaggedRef<T, Bits>;
+
+    bool is_some() const noexcept { return _ref._word > NicheWord; }
+
+    Handle& unwrap_unsafe() & noexcept { return _ref; }
+    const Handle& unwrap_unsafe() const& noexcept { return _ref; }
+    Handle&& unwrap_unsafe() && noexcept { return std::move(_ref); }
+
+    void swap(OptionStorage& other) noexcept { std::swap(_ref, other._ref); }
+
+    OptionStorage(NoneTag) noexcept : _ref{typename Handle::RawTag{}, 0} {}
+
+    explicit OptionStorage(NicheTag) noexcept
+        : _ref{typename Handle::RawTag{}, NicheWord} {}
+    bool is_niche() const noexcept { return _ref._word == NicheWord; }
+
+    OptionStorage(SomeTag, Handle ref) noexcept : _ref{ref} {
+#if defined(__GNUC__)
+        // pointer part is never null: lets the compiler fold is_some()
+        if (_ref._word <= NicheWord) {
+            __builtin_unreachable();
+        }
+#endif
+    }
+
+  private:
+    static constexpr std::uintptr_t NicheWord = 1;
+
+    Handle _ref;
+};
+
+} // namespace better
@@ -0,0 +1,383 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "executor.hpp"
+#include "inline_function.hpp"
+#include "invoke_with.hpp"
+#include "oneshot.hpp"
+#include "option.hpp"
+#include "result.hpp"
+
+#include "storage/raw.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace better {
+
+template <class T, class E>
+struct Task;
+
+template <class T, class E>
+struct TaskPromise;
+
+template <class T, class E>
+std::pair<TaskPromise<T, E>, Task<T, E>> make_task();
+
+template <class T>
+constexpr bool IsResult = false;
+
+template <class T, class E>
+constexpr bool IsResult<Result<T, E>> = true;
+
+template <class T>
+constexpr bool IsTask = false;
+
+template <class T, class E>
+constexpr bool IsTask<Task<T, E>> = true;
+
+namespace detail {
+
+// Meeting point of a producer (TaskPromise) and a single continuation.
+// Whichever of them comes second runs the continuation
+template <class T, class E>
+struct TaskState {
+    using Continuation = InlineFunction<void(Result<T, E>&&)>;
+
+    enum Status : std::uint32_t {
+        HasValue = 1,
+        HasContinuation = 2,
+        Consumed = 4,
+    };
+
+    std::atomic<std::uint32_t> status = 0;
+    std::atomic<std::uint32_t> refs = 2;
+    RawStorage<Result<T, E>> value;
+    Continuation continuation;
+    ExecutorRef executor;
+
+    ~TaskState() {
+        // the value is still here unless a continuation has taken it
+        if ((status.load(std::memory_order_acquire) &
+             (HasValue | Consumed)) == HasValue) {
+            std::destroy_at(value.get_raw());
+        }
+    }
+
+    void release() noexcept {
+        if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    template <class... Args>
+    void set_value(Args&&... args) {
+        new (value.get_bytes()) Result<T, E>(std::forward<Args>(args)...);
+        if (status.fetch_or(HasValue, std::memory_order_acq_rel) &
+            HasContinuation) {
+            dispatch();
+        }
+    }
+
+    void set_continuation(ExecutorRef ex, Continuation next) {
+        executor = ex;
+        continuation = std::move(next);
+        if (status.fetch_or(HasContinuation, std::memory_order_acq_rel) &
+            HasValue) {
+            dispatch();
+        }
+    }
+
+  private:
+    // Reference owned by a dispatched job. An executor may drop the job
+    // without running it (destroyed with pending work): the state and
+    // its value are freed all the same
+    struct JobRef {
+        explicit JobRef(TaskState* state) noexcept : state{state} {}
+        JobRef(JobRef&& other) noexcept
+            : state{std::exchange(other.state, nullptr)} {}
+        JobRef& operator=(JobRef&&) = delete;
+
+        ~JobRef() {
+            if (state != nullptr) {
+                state->release();
+            }
+        }
+
+        TaskState* state;
+    };
+
+    void dispatch() {
+        refs.fetch_add(1, std::memory_order_relaxed);
+        executor.execute([ref = JobRef{this}] { ref.state->run(); });
+    }
+
+    void run() {
+        Result<T, E>* const result = value.get_raw();
+        status.fetch_or(Consumed, std::memory_order_relaxed);
+        continuation(std::move(*result));
+        std::destroy_at(result);
+        // drop captured state right away, not with the last reference
+        continuation = Continuation{};
+    }
+};
+
+template <class R>
+struct TaskFor;
+
+template <class T, class E>
+struct TaskFor<Result<T, E>> {
+    static auto make() { return make_task<T, E>(); }
+};
+
+} // namespace detail
+
+// Creates a connected promise/task pair
+template <class T, class E>
+std::pair<TaskPromise<T, E>, Task<T, E>> make_task() {
+    auto* state = new detail::TaskState<T, E>{};
+    return {TaskPromise<T, E>{state}, Task<T, E>{state}};
+}
+
+// Producer side of a Task. Must be fulfilled exactly once:
+// dropping it unfulfilled leaves the Task pending forever
+template <class T, class E>
+struct TaskPromise {
+    TaskPromise(TaskPromise&& other) noexcept
+        : _state{std::exchange(other._state, nullptr)} {}
+
+    TaskPromise& operator=(TaskPromise&& other) noexcept {
+        TaskPromise tmp{std::move(other)};
+        std::swap(_state, tmp._state);
+        return *this;
+    }
+
+    TaskPromise(const TaskPromise&) = delete;
+    TaskPromise& operator=(const TaskPromise&) = delete;
+
+    ~TaskPromise() {
+        if (_state != nullptr) {
+            _state->release();
+        }
+    }
+
+    void set(Result<T, E> result) && { fulfill(std::move(result)); }
+
+    template <class... Args>
+    void set_ok(Args&&... args) && {
+        fulfill(Ok, std::forward<Args>(args)...);
+    }
+
+    template <class... Args>
+    void set_err(Args&&... args) && {
+        fulfill(Err, std::forward<Args>(args)...);
+    }
+
+  private:
+    friend std::pair<TaskPromise, Task<T, E>> make_task<T, E>();
+
+    explicit TaskPromise(detail::TaskState<T, E>* state) noexcept
+        : _state{state} {}
+
+    template <class... Args>
+    void fulfill(Args&&... args) {
+        auto* const state = std::exchange(_state, nullptr);
+        state->set_value(std::forward<Args>(args)...);
+        state->release();
+    }
+
+    detail::TaskState<T, E>* _state;
+};
+
+// Asynchronous Result<T, E>: combinators mirror Result, but run when the
+// value arrives, on the given executor (inline if none is given).
+// Nothing blocks except get(). Each stage costs one shared state
+// allocation; continuations are kept in InlineFunction buffers
+template <class T, class E>
+struct Task {
+    static Task ready(Result<T, E> result) {
+        auto [promise, task] = make_task<T, E>();
+        std::move(promise).set(std::move(result));
+        return std::move(task);
+    }
+
+    Task(Task&& other) noexcept
+        : _state{std::exchange(other._state, nullptr)} {}
+
+    Task& operator=(Task&& other) noexcept {
+        Task tmp{std::move(other)};
+        std::swap(_state, tmp._state);
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        if (_state != nullptr) {
+            _state->release();
+        }
+    }
+
+    // f(T) -> U
+    template <class F>
+        requires IsInvocableWith<F, T>
+    auto map(ExecutorRef ex, F&& f) && {
+        using R =
+            decltype(std::declval<Result<T, E>>().map(std::forward<F>(f)));
+        return std::move(*this).template then<R>(
+            ex, [f = std::forward<F>(f)](Result<T, E>&& result) mutable {
+                return std::move(result).map(std::move(f));
+            });
+    }
+
+    template <class F>
+        requires IsInvocableWith<F, T>
+    auto map(F&& f) && {
+        return std::move(*this).map(ExecutorRef{}, std::forward<F>(f));
+    }
+
+    // f(E) -> NewE
+    template <class F>
+        requires IsInvocableWith<F, E>
+    auto map_err(ExecutorRef ex, F&& f) && {
+        using R =
+            decltype(std::declval<Result<T, E>>().map_err(std::forward<F>(f)));
+        return std::move(*this).template then<R>(
+            ex, [f = std::forward<F>(f)](Result<T, E>&& result) mutable {
+                return std::move(result).map_err(std::move(f));
+            });
+    }
+
+    template <class F>
+        requires IsInvocableWith<F, E>
+    auto map_err(F&& f) && {
+        return std::move(*this).map_err(ExecutorRef{}, std::forward<F>(f));
+    }
+
+    // f(T) -> Result<U, E> or Task<U, E>
+    template <class F>
+        requires IsInvocableWith<F, T>
+    auto and_then(ExecutorRef ex, F&& f) && {
+        using R = std::decay_t<decltype(invoke_with(std::forward<F>(f),
+                                                    std::declval<T>()))>;
+        if constexpr (IsTask<R>) {
+            return std::move(*this).chain(ex, std::forward<F>(f),
+                                          static_cast<R*>(nullptr));
+        } else {
+            static_assert(IsResult<R>,
+                          "and_then continuation must return Result or Task");
+            return std::move(*this).template then<R>(
+                ex, [f = std::forward<F>(f)](Result<T, E>&& result) mutable {
+                    return std::move(result).and_then(std::move(f));
+                });
+        }
+    }
+
+    template <class F>
+        requires IsInvocableWith<F, T>
+    auto and_then(F&& f) && {
+        return std::move(*this).and_then(ExecutorRef{}, std::forward<F>(f));
+    }
+
+    // Blocks the calling thread until the value arrives.
+    // Meant for the edges of the program and tests
+    Result<T, E> get() && {
+        auto [sender, receiver] = oneshot<T, E>();
+        detail::TaskState<T, E>* const state = std::exchange(_state, nullptr);
+        state->set_continuation(
+            {}, [sender = std::move(sender)](Result<T, E>&& result) mutable {
+                std::move(sender).send(std::move(result));
+            });
+        state->release();
+        return receiver.recv().unwrap();
+    }
+
+  private:
+    template <class U, class G>
+    friend struct Task;
+
+    friend std::pair<TaskPromise<T, E>, Task> make_task<T, E>();
+
+    explicit Task(detail::TaskState<T, E>* state) noexcept : _state{state} {}
+
+    // Attaches `g(Result<T, E>&&) -> R` and returns task of its result
+    template <class R, class G>
+    auto then(ExecutorRef ex, G&& g) && {
+        auto [promise, next] = detail::TaskFor<R>::make();
+        attach(ex, [g = std::forward<G>(g), promise = std::move(promise)](
+                       Result<T, E>&& result) mutable {
+            std::move(promise).set(g(std::move(result)));
+        });
+        return std::move(next);
+    }
+
+    // and_then with a Task-returning continuation
+    template <class F, class U>
+    Task<U, E> chain(ExecutorRef ex, F&& f, Task<U, E>*) && {
+        auto [promise, next] = make_task<U, E>();
+        attach(ex, [f = std::forward<F>(f), promise = std::move(promise)](
+                       Result<T, E>&& result) mutable {
+            if (result.is_err()) {
+                std::move(promise).set_err(std::move(result).unwrap_err());
+                return;
+            }
+            Task<U, E> inner =
+                invoke_with(std::move(f), std::move(result).unwrap());
+            inner.attach({}, [promise = std::move(promise)](
+                                 Result<U, E>&& inner_result) mutable {
+                std::move(promise).set(std::move(inner_result));
+            });
+        });
+        return std::move(next);
+    }
+
+    template <class G>
+    void attach(ExecutorRef ex, G&& g) {
+        detail::TaskState<T, E>* const state = std::exchange(_state, nullptr);
+        state->set_continuation(ex, std::forward<G>(g));
+        state->release();
+    }
+
+    detail::TaskState<T, E>* _state;
+};
+
+// Runs `f() -> Result<T, E>` on `executor`
+template <class F>
+auto spawn(ExecutorRef executor, F&& f) {
+    using R = std::decay_t<std::invoke_result_t<F&>>;
+    static_assert(IsResult<R>, "spawned function must return Result");
+    return [&]<class T, class E>(Result<T, E>*) {
+        auto [promise, task] = make_task<T, E>();
+        executor.execute(
+            [f = std::forward<F>(f), promise = std::move(promise)]() mutable {
+                std::move(promise).set(f());
+            });
+        return std::move(task);
+    }(static_cast<R*>(nullptr));
+}
+
+} // namespace better
@@ -0,0 +1,180 @@
+/*
+Copyright 2024 Dmitry Sviridkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "executor.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <concepts>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace better {
+
+// Source of time that runs jobs at a given point of it.
+// Jobs run on the timer's own thread and should only hand work
+// over to an executor
+template <class T>
+concept Timer = requires(T& timer, typename T::time_point at, Job job) {
+    { timer.now() } -> std::same_as<typename T::time_point>;
+    timer.call_at(at, std::move(job));
+};
+
+namespace detail {
+
+// Min-heap of pending timer jobs; equal deadlines keep insertion order
+template <class TimePoint>
+struct TimerQueue {
+    struct Entry {
+        TimePoint at;
+        std::uint64_t seq;
+        Job job;
+    };
+
+    void push(TimePoint at, Job job) {
+        _entries.push_back(Entry{at, _seq++, std::move(job)});
+        std::push_heap(_entries.begin(), _entries.end(), later);
+    }
+
+    bool empty() const noexcept { return _entries.empty(); }
+
+    TimePoint next_at() const noexcept { return _entries.front().at; }
+
+    Job pop() {
+        std::pop_heap(_entries.begin(), _entries.end(), later);
+        Job job = std::move(_entries.back().job);
+        _entries.pop_back();
+        return job;
+    }
+
+  private:
+    static bool later(const Entry& a, const Entry& b) noexcept {
+        return a.at != b.at ? a.at > b.at : a.seq > b.seq;
+    }
+
+    std::vector<Entry> _entries;
+    std::uint64_t _seq = 0;
+};
+
+} // namespace detail
+
+// Steady clock with one background thread firing due jobs.
+// Jobs still pending on destruction are dropped without running
+struct TimerThread {
+    using time_point = std::chrono::steady_clock::time_point;
+
+    TimerThread() : _thread{[this] { work(); }} {}
+
+    TimerThread(const TimerThread&) = delete;
+    TimerThread& operator=(const TimerThread&) = delete;
+
+    ~TimerThread() {
+        {
+            std::lock_guard lock{_mutex};
+            _stop = true;
+        }
+        _wakeup.notify_one();
+        _thread.join();
+    }
+
+    time_point now() const noexcept { return std::chrono::steady_clock::now(); }
+
+    void call_at(time_point at, Job job) {
+        {
+            std::lock_guard lock{_mutex};
+            _queue.push(at, std::move(job));
+        }
+        _wakeup.notify_one();
+    }
+
+  private:
+    void work() {
+        std::unique_lock lock{_mutex};
+        while (!_stop) {
+            if (_queue.empty()) {
+                _wakeup.wait(lock);
+            } else if (_queue.next_at() > now()) {
+                _wakeup.wait_until(lock, _queue.next_at());
+            } else {
+                Job job = _queue.pop();
+                lock.unlock();
+                job();
+                lock.lock();
+            }
+        }
+    }
+
+    std::mutex _mutex;
+    std::condition_variable _wakeup;
+    detail::TimerQueue<time_point> _queue;
+    bool _stop = false;
+    std::thread _thread;
+};
+
+// Manually driven clock for tests: time stands still until advance(),
+// which runs due jobs on the calling thread in deadline order
+struct FakeClock {
+    using time_point = std::chrono::steady_clock::time_point;
+
+    time_point now() const {
+        std::lock_guard lock{_mutex};
+        return _now;
+    }
+
+    void call_at(time_point at, Job job) {
+        std::lock_guard lock{_mutex};
+        _queue.push(at, std::move(job));
+    }
+
+    // Returns number of jobs run
+    std::size_t advance(std::chrono::steady_clock::duration by) {
+        std::unique_lock lock{_mutex};
+        const time_point until = _now + by;
+        std::size_t count = 0;
+        while (!_queue.empty() && _queue.next_at() <= until) {
+            // jobs see the time they were scheduled for
+            _now = std::max(_now, _queue.next_at());
+            Job job = _queue.pop();
+            lock.unlock();
+            job();
+            ++count;
+            lock.lock();
+        }
+        _now = until;
+        return count;
+    }
+
+  private:
+    mutable std::mutex _mutex;
+    time_point _now{};
+    detail::TimerQueue<time_point> _queue;
+};
+
+static_assert(Timer<TimerThread>);
+static_assert(Timer<FakeClock>);
+
+} // namespace better
@@ -1,17 +1,29 @@
+#include <compact_ref.hpp>
+#include <flat_map.hpp>
 #include <option.hpp>
+#include <relocate.hpp>
+#include <result.hpp>
+#include <sparse_option_vec.hpp>
 
 #include <algorithm>
 #include <chrono>
 #include <iostream>
+#include <memory>
+#include <numeric>
 #include <optional>
 #include <random>
+#include <string>
 #include <string_view>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+using better::Err;
 using better::None;
+using better::Ok;
 using better::Option;
 using better::Ref;
+using better::Result;
 using better::Some;
 
 std::string random_string(size_t len) {
@@ -28,7 +40,8 @@ std::string random_string(size_t len) {
 template <class F> auto time(std::string_view title, F &&f) -> uint64_t {
     // std::cout << "testing: " << title << "\n";
     const auto start = std::chrono::high_resolution_clock::now();
-    auto ret = std::forward<F>(f)();
+    // volatile keeps the result and the work behind it alive
+    volatile auto ret = std::forward<F>(f)();
     const auto finish = std::chrono::high_resolution_clock::now();
     auto elapsed =
         std::chrono::duration_cast<std::chrono::microseconds>(finish - start)
@@ -68,6 +81,18 @@ size_t test_better_optional_refs(const std::vector<std::string> &str) {
     return sum_of_lens;
 }
 
+void print_measurements(std::string_view title,
+                        std::vector<uint64_t>& measurements) {
+    const size_t runs = measurements.size();
+    std::cout << title << "\n";
+    std::sort(measurements.begin(), measurements.end());
+    std::cout << "Elapsed min: " << measurements[0] << " usec\n";
+    std::cout << "Elapsed p50: " << measurements[runs / 2] << " usec\n";
+    std::cout << "Elapsed p90: " << measurements[90 * runs / 100] << " usec\n";
+    std::cout << "Elapsed p99: " << measurements[99 * runs / 100] << " usec\n";
+    std::cout << "Elapsed max: " << measurements.back() << " usec\n";
+}
+
 void bench_references() {
     const size_t N = 10000;
     std::vector<std::string> strs;
@@ -84,14 +109,293 @@ void bench_references() {
         // m = time("std::optional", [&] { return test_std_optional_refs(strs);
         // });
     }
-    std::cout << "better::Option\n";
-    // std::cout << "std::optional\n";
-    std::sort(measurements.begin(), measurements.end());
-    std::cout << "Elapsed min: " << measurements[0] << " usec\n";
-    std::cout << "Elapsed p50: " << measurements[RUNS / 2] << " usec\n";
-    std::cout << "Elapsed p90: " << measurements[90 * RUNS / 100] << " usec\n";
-    std::cout << "Elapsed p99: " << measurements[99 * RUNS / 100] << " usec\n";
-    std::cout << "Elapsed max: " << measurements.back() << " usec\n";
+    print_measurements("better::Option", measurements);
+    // print_measurements("std::optional", measurements);
 }
 
-int main() { bench_references(); };
\ No newline at end of file
+// Minimal growable buffer that moves elements with better::relocate_n
+// on reallocation
+template <class T> struct RelocatingBuffer {
+    T *data = nullptr;
+    size_t size = 0;
+    size_t capacity = 0;
+
+    template <class... Args> void emplace_back(Args &&...args) {
+        if (size == capacity) {
+            const size_t new_capacity = capacity ? 2 * capacity : 1;
+            auto new_data =
+                static_cast<T *>(::operator new(new_capacity * sizeof(T)));
+            better::relocate_n(data, size, new_data);
+            ::operator delete(data);
+            data = new_data;
+            capacity = new_capacity;
+        }
+        new (data + size) T(std::forward<Args>(args)...);
+        ++size;
+    }
+
+    ~RelocatingBuffer() {
+        std::destroy_n(data, size);
+        ::operator delete(data);
+    }
+};
+
+template <class Container, class Make>
+size_t test_growth(size_t n, Make &&make) {
+    Container c;
+    for (size_t i = 0; i < n; ++i) {
+        c.emplace_back(make(i));
+    }
+    return c.size;
+}
+
+template <class T> struct StdVector : std::vector<T> {
+    size_t size = 0;
+    template <class U> void emplace_back(U &&x) {
+        std::vector<T>::emplace_back(std::forward<U>(x));
+        ++size;
+    }
+};
+
+template <class T, class Make>
+void bench_growth(std::string_view title, Make make) {
+    const size_t N = 100000;
+    const size_t RUNS = 100;
+    std::vector<uint64_t> measurements(RUNS);
+    for (auto &m : measurements) {
+        m = time(title, [&] { return test_growth<StdVector<T>>(N, make); });
+    }
+    print_measurements(std::string(title) + " std::vector", measurements);
+    for (auto &m : measurements) {
+        m = time(title,
+                 [&] { return test_growth<RelocatingBuffer<T>>(N, make); });
+    }
+    print_measurements(std::string(title) + " relocating buffer",
+                       measurements);
+}
+
+void bench_relocation() {
+    // payloads are not allocating, so the reallocation cost dominates
+    using OptVec = Option<std::vector<int>>;
+    bench_growth<OptVec>("Option<vector<int>>", [](size_t i) {
+        return i % 2 ? OptVec{Some} : OptVec{None};
+    });
+
+    using ResPtr = Result<std::unique_ptr<int>, int>;
+    bench_growth<ResPtr>("Result<unique_ptr<int>, int>", [](size_t i) {
+        return i % 16 ? ResPtr{Ok, nullptr} : ResPtr{Err, static_cast<int>(i)};
+    });
+}
+
+template <class Column> uint64_t scan_sum(const Column &column) {
+    uint64_t sum = 0;
+    for (const auto &value : column) {
+        if (value.is_some()) {
+            const uint64_t &x = value.unwrap();
+            sum += x;
+        }
+    }
+    return sum;
+}
+
+void bench_sparse(double density) {
+    const size_t N = 1 << 20;
+    const size_t RUNS = 100;
+    std::mt19937 gen(42);
+    std::bernoulli_distribution is_some(density);
+
+    better::SparseOptionVec<uint64_t> sparse;
+    std::vector<Option<uint64_t>> dense;
+    dense.reserve(N);
+    for (size_t i = 0; i < N; ++i) {
+        if (is_some(gen)) {
+            sparse.push_some(i);
+            dense.emplace_back(Some, i);
+        } else {
+            sparse.push_none();
+            dense.emplace_back(None);
+        }
+    }
+    sparse.shrink_to_fit();
+
+    const std::string title =
+        "density " + std::to_string(density * 100) + "%";
+    std::cout << title << " memory: SparseOptionVec " << sparse.memory_bytes()
+              << " bytes, vector<Option> " << dense.size() * sizeof(dense[0])
+              << " bytes\n";
+
+    std::vector<uint64_t> measurements(RUNS);
+    for (auto &m : measurements) {
+        m = time(title, [&] { return scan_sum(dense); });
+    }
+    print_measurements(title + " scan vector<Option>", measurements);
+    for (auto &m : measurements) {
+        m = time(title, [&] { return scan_sum(sparse); });
+    }
+    print_measurements(title + " scan SparseOptionVec", measurements);
+
+    std::vector<size_t> positions(N / 16);
+    std::uniform_int_distribution<size_t> position(0, N - 1);
+    std::generate(positions.begin(), positions.end(),
+                  [&] { return position(gen); });
+    for (auto &m : measurements) {
+        m = time(title, [&] {
+            uint64_t sum = 0;
+            for (size_t i : positions) {
+                auto value = sparse.get(i);
+                if (value.is_some()) {
+                    sum += value.unwrap().get();
+                }
+            }
+            return sum;
+        });
+    }
+    print_measurements(title + " random get SparseOptionVec", measurements);
+}
+
+template <class Map, class Find>
+void bench_map(const std::string &title, const std::vector<uint64_t> &keys,
+               Find find) {
+    const size_t RUNS = 3;
+    const size_t n = keys.size() / 2;
+    std::vector<uint64_t> inserts(RUNS), hits(RUNS), misses(RUNS);
+    for (size_t run = 0; run < RUNS; ++run) {
+        Map map;
+        inserts[run] = time(title, [&] {
+            for (size_t i = 0; i < n; ++i) {
+                map.insert({keys[i], i});
+            }
+            return map.size();
+        });
+        hits[run] = time(title, [&] {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < n; ++i) {
+                sum += find(map, keys[i]);
+            }
+            return sum;
+        });
+        // second half of keys was never inserted
+        misses[run] = time(title, [&] {
+            uint64_t sum = 0;
+            for (size_t i = n; i < keys.size(); ++i) {
+                sum += find(map, keys[i]);
+            }
+            return sum;
+        });
+    }
+    print_measurements(title + " insert", inserts);
+    print_measurements(title + " find hit", hits);
+    print_measurements(title + " find miss", misses);
+}
+
+// FlatMap::insert takes key and value arguments instead of a pair
+struct BenchFlatMap : better::FlatMap<uint64_t, uint64_t> {
+    void insert(std::pair<uint64_t, uint64_t> kv) {
+        better::FlatMap<uint64_t, uint64_t>::insert(kv.first, kv.second);
+    }
+};
+
+void bench_flat_map(size_t n) {
+    std::mt19937_64 gen(42);
+    std::vector<uint64_t> keys(2 * n);
+    std::generate(keys.begin(), keys.end(), [&] { return gen(); });
+
+    const std::string suffix = " " + std::to_string(n) + " keys";
+    bench_map<BenchFlatMap>(
+        "FlatMap" + suffix, keys, [](const BenchFlatMap &map, uint64_t key) {
+            auto found = map.find(key);
+            return found.is_some() ? found.unwrap().get() : 0;
+        });
+    bench_map<std::unordered_map<uint64_t, uint64_t>>(
+        "std::unordered_map" + suffix, keys,
+        [](const std::unordered_map<uint64_t, uint64_t> &map, uint64_t key) {
+            auto it = map.find(key);
+            return it != map.end() ? it->second : 0;
+        });
+}
+
+struct PtrNode {
+    Option<Ref<PtrNode>> next;
+    uint32_t value;
+};
+
+struct CompactNode;
+using CompactNodeArena = better::Arena<CompactNode>;
+
+struct CompactNode {
+    Option<better::CompactRef<CompactNode, CompactNodeArena>> next;
+    uint32_t value;
+};
+
+template <class Node> uint64_t chase(Option<Node> node) {
+    uint64_t sum = 0;
+    while (node.is_some()) {
+        const auto &current = node.unwrap().get();
+        sum += current.value;
+        node = current.next;
+    }
+    return sum;
+}
+
+// Single cycle-free path through all nodes in random order:
+// every step is a cache miss, so node size decides the traffic
+void bench_pointer_chasing(size_t n) {
+    const size_t RUNS = 5;
+    std::mt19937 gen(42);
+    std::vector<uint32_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), gen);
+
+    std::vector<PtrNode> ptr_nodes(n, PtrNode{None, 0});
+    for (size_t i = 0; i < n; ++i) {
+        auto &node = ptr_nodes[order[i]];
+        node.value = static_cast<uint32_t>(i);
+        if (i + 1 < n) {
+            node.next = Option{Some, Ref{ptr_nodes[order[i + 1]]}};
+        }
+    }
+
+    CompactNodeArena arena{static_cast<uint32_t>(n)};
+    std::vector<better::CompactRef<CompactNode, CompactNodeArena>> refs;
+    refs.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        refs.push_back(arena.emplace(CompactNode{None, 0}).unwrap());
+    }
+    for (size_t i = 0; i < n; ++i) {
+        auto &node = refs[order[i]].get();
+        node.value = static_cast<uint32_t>(i);
+        if (i + 1 < n) {
+            node.next = Option{Some, refs[order[i + 1]]};
+        }
+    }
+
+    const std::string title = std::to_string(n) + " nodes";
+    std::cout << title << " node size: Ref " << sizeof(PtrNode)
+              << " bytes, CompactRef " << sizeof(CompactNode) << " bytes\n";
+    std::vector<uint64_t> measurements(RUNS);
+    for (auto &m : measurements) {
+        m = time(title, [&] {
+            return chase(Option{Some, Ref{ptr_nodes[order[0]]}});
+        });
+    }
+    print_measurements(title + " chase Ref", measurements);
+    for (auto &m : measurements) {
+        m = time(title, [&] { return chase(Option{Some, refs[order[0]]}); });
+    }
+    print_measurements(title + " chase CompactRef", measurements);
+}
+
+int main(int argc, char **argv) {
+    bench_references();
+    bench_relocation();
+    bench_sparse(0.001);
+    bench_sparse(0.01);
+    bench_sparse(0.5);
+    bench_flat_map(1'000'000);
+    bench_flat_map(10'000'000);
+    bench_pointer_chasing(10'000'000);
+    // needs ~10GB of memory for both maps
+    if (argc > 1 && std::string_view{argv[1]} == "--large") {
+        bench_flat_map(100'000'000);
+    }
+};
\ No newline at end of file
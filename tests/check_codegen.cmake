@@ -0,0 +1,52 @@
+# Compiles SOURCE to assembly at -O2 and checks that each function in
+# FUNCTIONS has no more instructions than its manual_ counterpart.
+# Only instruction counts are compared, so register allocation and
+# block layout differences do not matter.
+#
+# cmake -DCXX=... -DINCLUDE=... -DSOURCE=... -DOUTPUT=...
+#       -DFUNCTIONS=at;get -P check_codegen.cmake
+
+execute_process(
+    COMMAND ${CXX} -std=c++20 -O2 -S -fno-asynchronous-unwind-tables
+            -I${INCLUDE} ${SOURCE} -o ${OUTPUT}
+    RESULT_VARIABLE compiled)
+if(NOT compiled EQUAL 0)
+    message(FATAL_ERROR "cannot compile ${SOURCE}")
+endif()
+
+file(STRINGS ${OUTPUT} lines)
+
+# Instructions are indented and are neither directives nor labels
+function(count_instructions name out)
+    set(inside FALSE)
+    set(count 0)
+    foreach(line IN LISTS lines)
+        if(line MATCHES "^_?${name}:")
+            set(inside TRUE)
+        elseif(inside AND line MATCHES "^[_A-Za-z][_A-Za-z0-9]*:")
+            break()
+        elseif(inside AND line MATCHES "^\t\\.size")
+            break()
+        elseif(inside AND line MATCHES "^\t[a-z]")
+            math(EXPR count "${count} + 1")
+        endif()
+    endforeach()
+    if(count EQUAL 0)
+        message(FATAL_ERROR "no code found for ${name}")
+    endif()
+    set(${out} ${count} PARENT_SCOPE)
+endfunction()
+
+set(failed FALSE)
+foreach(function IN LISTS FUNCTIONS)
+    count_instructions(adapter_${function} adapter)
+    count_instructions(manual_${function} manual)
+    message(STATUS "${function}: adapter ${adapter}, manual ${manual}")
+    if(adapter GREATER manual)
+        set(failed TRUE)
+    endif()
+endforeach()
+
+if(failed)
+    message(FATAL_ERROR "adapters generate more code than manual lookups")
+endif()
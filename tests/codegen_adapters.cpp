@@ -0,0 +1,43 @@
+#include "adapters.hpp"
+
+#include <cstddef>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+// Never linked: check_codegen.cmake compiles this file to assembly and
+// requires every adapter_X to be as short as its hand-written manual_X.
+// The Option<Ref<T>> returned by the adapters must fold away completely
+
+extern "C" {
+
+int adapter_at(const std::vector<int>& v, std::size_t i) {
+    auto hit = better::at(v, i);
+    return hit.is_some() ? *hit.unwrap() : -1;
+}
+
+int manual_at(const std::vector<int>& v, std::size_t i) {
+    return i < v.size() ? v[i] : -1;
+}
+
+int adapter_get(const std::map<int, int>& m, int key) {
+    auto hit = better::get(m, key);
+    return hit.is_some() ? *hit.unwrap() : -1;
+}
+
+int manual_get(const std::map<int, int>& m, int key) {
+    const auto it = m.find(key);
+    return it != m.end() ? it->second : -1;
+}
+
+int adapter_get_hash(const std::unordered_map<int, int>& m, int key) {
+    auto hit = better::get(m, key);
+    return hit.is_some() ? *hit.unwrap() : -1;
+}
+
+int manual_get_hash(const std::unordered_map<int, int>& m, int key) {
+    const auto it = m.find(key);
+    return it != m.end() ? it->second : -1;
+}
+
+} // extern "C"
@@ -0,0 +1,127 @@
+#include "adapters.hpp"
+
+#include <deque>
+#include <iostream>
+#include <list>
+#include <map>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using better::Option;
+using better::Ref;
+
+static_assert(sizeof(decltype(better::at(std::declval<std::vector<int>&>(),
+                                         0))) == sizeof(int*));
+static_assert(
+    std::is_same_v<decltype(better::at(
+                       std::declval<const std::vector<int>&>(), 0)),
+                   Option<Ref<const int>>>);
+static_assert(std::is_same_v<decltype(better::at(std::span<int>{}, 0)),
+                             Option<Ref<int>>>);
+
+// Counts constructions to make sure lookups don't build temporary keys
+struct Name {
+    static inline int constructed = 0;
+
+    explicit Name(std::string s) : value{std::move(s)} { ++constructed; }
+    Name(const Name& other) : value{other.value} { ++constructed; }
+
+    std::string value;
+};
+
+struct NameLess {
+    using is_transparent = void;
+    bool operator()(const Name& a, const Name& b) const {
+        return a.value < b.value;
+    }
+    bool operator()(const Name& a, std::string_view b) const {
+        return a.value < b;
+    }
+    bool operator()(std::string_view a, const Name& b) const {
+        return a < b.value;
+    }
+};
+
+struct NameHash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view s) const {
+        return std::hash<std::string_view>{}(s);
+    }
+    std::size_t operator()(const Name& n) const { return (*this)(n.value); }
+};
+
+struct NameEq {
+    using is_transparent = void;
+    bool operator()(const Name& a, const Name& b) const {
+        return a.value == b.value;
+    }
+    bool operator()(const Name& a, std::string_view b) const {
+        return a.value == b;
+    }
+    bool operator()(std::string_view a, const Name& b) const {
+        return a == b.value;
+    }
+};
+
+void test_adapters_maps() {
+    std::cout << "test_adapters_maps\n";
+    std::map<Name, int, NameLess> ordered;
+    ordered.emplace(Name{"a"}, 1);
+    std::unordered_map<Name, int, NameHash, NameEq> hashed;
+    hashed.emplace(Name{"b"}, 2);
+
+    const int before = Name::constructed;
+    better::get(ordered, std::string_view{"a"}).unwrap().get() = 10;
+    std::cout << "map: " << ordered.begin()->second << " missing: "
+              << better::get(ordered, std::string_view{"z"}).is_some()
+              << "\n";
+    const auto& const_hashed = hashed;
+    std::cout << "unordered_map: "
+              << better::get(const_hashed, std::string_view{"b"})
+                     .unwrap()
+                     .get()
+              << " missing: "
+              << better::get(const_hashed, std::string_view{"z"}).is_some()
+              << "\n";
+    std::cout << "temporary keys: " << Name::constructed - before << "\n";
+}
+
+void test_adapters_sequences() {
+    std::cout << "test_adapters_sequences\n";
+    std::vector<int> v = {1, 3, 5, 7};
+    std::cout << "at: " << better::at(v, 2).unwrap().get()
+              << " out of range: " << better::at(v, 4).is_some() << "\n";
+    std::cout << "front: " << better::front(v).unwrap().get()
+              << " back: " << better::back(v).unwrap().get() << "\n";
+
+    std::span<const int> s{v};
+    std::cout << "span at: " << better::at(s, 1).unwrap().get()
+              << " span back: " << better::back(s.first(0)).is_some()
+              << "\n";
+
+    std::cout << "binary_find: " << better::binary_find(v, 5).unwrap().get()
+              << " missing: " << better::binary_find(v, 4).is_some() << "\n";
+    std::cout << "find_if: "
+              << better::find_if(v, [](int x) { return x > 4; })
+                     .unwrap()
+                     .get()
+              << " find missing: " << better::find(v, 2).is_some() << "\n";
+
+    std::list<std::string> names = {"x", "y"};
+    better::front(names).unwrap().get() += "!";
+    std::cout << "list front: " << names.front() << "\n";
+
+    std::deque<std::string> queue = {"first", "last"};
+    std::cout << "pop_back: " << better::pop_back(queue).unwrap() << " "
+              << better::pop_back(queue).unwrap() << " "
+              << better::pop_back(queue).is_some() << "\n";
+}
+
+int main() {
+    test_adapters_maps();
+    test_adapters_sequences();
+    return 0;
+}
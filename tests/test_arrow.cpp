@@ -0,0 +1,131 @@
+#include "arrow.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using better::ColumnView;
+using better::arrow::ArrowColumn;
+using better::arrow::ImportError;
+
+static_assert(std::forward_iterator<ArrowColumn<double>::Iterator>);
+
+struct Batch {
+    std::vector<double> values;
+    std::vector<std::uint8_t> validity;
+};
+
+// Every third value is null
+std::shared_ptr<Batch> make_batch(std::size_t n) {
+    auto batch = std::make_shared<Batch>();
+    batch->values.resize(n);
+    batch->validity.resize((n + 7) / 8);
+    for (std::size_t i = 0; i < n; ++i) {
+        batch->values[i] = static_cast<double>(i) / 4;
+        if (i % 3 != 0) {
+            batch->validity[i / 8] |= 1u << (i % 8);
+        }
+    }
+    return batch;
+}
+
+void test_arrow_export() {
+    std::cout << "test_arrow_export\n";
+    auto batch = make_batch(20);
+    ColumnView<double> view{batch->values.data(), batch->validity.data(),
+                            batch->values.size()};
+
+    ArrowSchema schema;
+    better::arrow::export_schema<double>(&schema, "score");
+    std::cout << "format: " << schema.format << " name: " << schema.name
+              << " nullable: "
+              << ((schema.flags & ARROW_FLAG_NULLABLE) != 0) << "\n";
+
+    ArrowArray array;
+    better::arrow::export_column(view, &array, batch);
+    std::cout << "length: " << array.length << " buffers: " << array.n_buffers
+              << "\n";
+    std::cout << "zero copy: "
+              << (array.buffers[0] == batch->validity.data() &&
+                  array.buffers[1] == batch->values.data())
+              << "\n";
+    std::cout << "owners while exported: " << batch.use_count() << "\n";
+
+    array.release(&array);
+    schema.release(&schema);
+    std::cout << "owners after release: " << batch.use_count() << "\n";
+    std::cout << "released: " << (array.release == nullptr) << " "
+              << (schema.release == nullptr) << "\n";
+}
+
+void test_arrow_import() {
+    std::cout << "test_arrow_import\n";
+    auto batch = make_batch(20);
+    ColumnView<double> view{batch->values.data(), batch->validity.data(),
+                            batch->values.size()};
+
+    ArrowSchema schema;
+    better::arrow::export_schema<double>(&schema);
+    ArrowArray array;
+    better::arrow::export_column(view, &array, batch);
+    // consumer side slice
+    array.offset = 2;
+    array.length = 10;
+
+    {
+        auto column =
+            better::arrow::import_column<double>(&array, schema).unwrap();
+        std::cout << "moved out: " << (array.release == nullptr) << "\n";
+        std::cout << "size: " << column.size() << "\n";
+        std::cout << "values:";
+        for (auto value : column) {
+            if (value.is_some()) {
+                std::cout << " " << value.unwrap().get();
+            } else {
+                std::cout << " null";
+            }
+        }
+        std::cout << "\n";
+        std::cout << "out of range: " << column.get(10).is_some() << "\n";
+    }
+    std::cout << "owners after column is gone: " << batch.use_count() << "\n";
+    schema.release(&schema);
+}
+
+void test_arrow_import_errors() {
+    std::cout << "test_arrow_import_errors\n";
+    std::vector<double> values = {1.0, 2.0};
+    ColumnView<double> view{values.data(), nullptr, values.size()};
+
+    ArrowSchema schema;
+    better::arrow::export_schema<std::int32_t>(&schema);
+    ArrowArray array;
+    better::arrow::export_column(view, &array);
+    // no validity bitmap means all values are present
+    array.buffers[0] = nullptr;
+
+    auto mismatch = better::arrow::import_column<double>(&array, schema);
+    std::cout << "wrong format: "
+              << better::arrow::message(mismatch.unwrap_err()) << "\n";
+    std::cout << "still owned by caller: " << (array.release != nullptr)
+              << "\n";
+    schema.release(&schema);
+
+    better::arrow::export_schema<double>(&schema);
+    auto column = better::arrow::import_column<double>(&array, schema);
+    std::cout << "no bitmap: " << column.unwrap().get(1).is_some() << "\n";
+
+    auto released = better::arrow::import_column<double>(&array, schema);
+    std::cout << "released: " << better::arrow::message(released.unwrap_err())
+              << "\n";
+    schema.release(&schema);
+}
+
+int main() {
+    test_arrow_export();
+    test_arrow_import();
+    test_arrow_import_errors();
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include "column.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <type_traits>
+
+#include <unistd.h>
+
+using better::ColumnReader;
+using better::ColumnWriter;
+using better::None;
+using better::Option;
+using better::Some;
+
+struct Feature {
+    float score;
+    std::uint32_t bucket;
+};
+
+std::string temp_path() {
+    char path[] = "/tmp/better_column_XXXXXX";
+    const int fd = ::mkstemp(path);
+    if (fd < 0) {
+        std::cout << "cannot create temp file\n";
+        std::exit(1);
+    }
+    ::close(fd);
+    return path;
+}
+
+void test_column_roundtrip() {
+    std::cout << "test_column_roundtrip\n";
+    const auto path = temp_path();
+    const std::size_t N = 100000;
+
+    auto writer = ColumnWriter<Feature>::create(path.c_str()).unwrap();
+    for (std::size_t i = 0; i < N; ++i) {
+        if (i % 3 == 0) {
+            writer.push_none().unwrap();
+        } else {
+            writer
+                .push(Option<Feature>{
+                    Some, Feature{static_cast<float>(i) / 2,
+                                  static_cast<std::uint32_t>(i)}})
+                .unwrap();
+        }
+    }
+    std::move(writer).finish().unwrap();
+
+    auto reader = ColumnReader<Feature>::open(path.c_str()).unwrap();
+    std::cout << "size: " << reader.size() << "\n";
+
+    std::size_t present = 0;
+    bool all_match = true;
+    for (std::size_t i = 0; i < reader.size(); ++i) {
+        auto value = reader.get(i);
+        if (value.is_some() != (i % 3 != 0)) {
+            all_match = false;
+        }
+        value.map([&](const Feature& f) {
+            ++present;
+            all_match = all_match && f.bucket == i;
+        });
+    }
+    std::cout << "present: " << present << " all match: " << all_match
+              << "\n";
+    std::cout << "out of range: " << reader.get(N).is_some() << "\n";
+
+    ::unlink(path.c_str());
+}
+
+void test_column_invalid() {
+    std::cout << "test_column_invalid\n";
+    const auto path = temp_path();
+
+    auto empty = ColumnReader<Feature>::open(path.c_str());
+    std::cout << "empty file: " << empty.unwrap_err().message() << "\n";
+
+    auto writer = ColumnWriter<std::uint32_t>::create(path.c_str()).unwrap();
+    writer.push_some(1).unwrap();
+    std::move(writer).finish().unwrap();
+
+    // written with another value size
+    auto wrong_type = ColumnReader<Feature>::open(path.c_str());
+    std::cout << "wrong type: " << wrong_type.unwrap_err().message() << "\n";
+
+    ::unlink(path.c_str());
+}
+
+// Trivially copyable, but no default constructor
+struct Price {
+    explicit Price(std::int32_t cents) : cents{cents} {}
+
+    std::int32_t cents;
+};
+
+void test_column_no_default_ctor() {
+    std::cout << "test_column_no_default_ctor\n";
+    static_assert(!std::is_default_constructible_v<Price>);
+    const auto path = temp_path();
+
+    auto writer = ColumnWriter<Price>::create(path.c_str()).unwrap();
+    writer.push_some(Price{250}).unwrap();
+    writer.push_none().unwrap();
+    std::move(writer).finish().unwrap();
+
+    auto reader = ColumnReader<Price>::open(path.c_str()).unwrap();
+    std::cout << "price: " << reader.get(0).unwrap()->cents
+              << " missing: " << reader.get(1).is_none() << "\n";
+
+    ::unlink(path.c_str());
+}
+
+int main() {
+    test_column_roundtrip();
+    test_column_invalid();
+    test_column_no_default_ctor();
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include "compact_ref.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using better::Arena;
+using better::CompactRef;
+using better::None;
+using better::Option;
+using better::Some;
+
+struct Node;
+using NodeArena = Arena<Node>;
+using NodeRef = CompactRef<Node, NodeArena>;
+
+struct Node {
+    int value;
+    Option<NodeRef> next;
+};
+
+static_assert(sizeof(NodeRef) == 4);
+static_assert(sizeof(Option<NodeRef>) == 4);
+static_assert(sizeof(Option<Option<NodeRef>>) == 4);
+static_assert(sizeof(Node) == 8);
+
+void test_compact_ref() {
+    std::cout << "test_compact_ref\n";
+    NodeArena arena{3};
+    Option<NodeRef> head = None;
+    for (int i = 1; i <= 3; ++i) {
+        head = arena.emplace(Node{i, head});
+    }
+    std::cout << "full: " << arena.emplace(Node{4, None}).is_none() << "\n";
+
+    std::cout << "list:";
+    for (auto node = head; node.is_some(); node = node.unwrap()->next) {
+        std::cout << " " << node.unwrap()->value;
+    }
+    std::cout << "\n";
+
+    NodeRef first = head.unwrap();
+    first->value = 30;
+    const NodeRef frozen = first;
+    static_assert(std::is_same_v<decltype(frozen.get()), const Node&>);
+    CompactRef<const Node, NodeArena> as_const = first;
+    std::cout << "mutated: " << as_const->value
+              << " index: " << first.index()
+              << " same as Ref: " << (&first.ref().get() == &*frozen)
+              << "\n";
+
+    Option<Option<NodeRef>> nested{Some, None};
+    std::cout << "nested some(none): " << nested.is_some() << " "
+              << nested.unwrap().is_none() << "\n";
+}
+
+void test_arena_lifetime() {
+    std::cout << "test_arena_lifetime\n";
+    {
+        Arena<std::string> strings{2};
+        strings.emplace("kept alive by the arena").unwrap();
+        try {
+            Arena<std::string> second{1};
+        } catch (const std::logic_error& e) {
+            std::cout << "second arena: " << e.what() << "\n";
+        }
+        // a tag gives an independent arena of the same type
+        struct Other {};
+        Arena<std::string, Other> other{1};
+        auto s = other.emplace("other").unwrap();
+        std::cout << "tagged: " << *s << "\n";
+    }
+    Arena<std::string> again{1};
+    std::cout << "recreated: " << again.emplace("ok").unwrap()->size() << "\n";
+}
+
+// Threads racing to create the arena: exactly one of them wins
+void test_arena_race() {
+    std::cout << "test_arena_race\n";
+    struct Raced {};
+    std::atomic<int> created = 0;
+    std::atomic<int> rejected = 0;
+    std::atomic<int> attempted = 0;
+    // the winner keeps its arena until every thread has tried
+    auto wait_for_all = [&] {
+        ++attempted;
+        while (attempted.load() < 4) {
+            std::this_thread::yield();
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            try {
+                Arena<int, Raced> arena{16};
+                ++created;
+                wait_for_all();
+            } catch (const std::logic_error&) {
+                ++rejected;
+                wait_for_all();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::cout << "created: " << created.load()
+              << " rejected: " << rejected.load() << "\n";
+}
+
+int main() {
+    test_compact_ref();
+    test_arena_lifetime();
+    test_arena_race();
+    return 0;
+}
@@ -0,0 +1,181 @@
+#include "flat_map.hpp"
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+using better::FlatMap;
+using better::Option;
+using better::Ref;
+
+static_assert(sizeof(Option<Ref<int>>) == sizeof(int*));
+
+// lookups are noexcept only as far as Hash and Eq are
+struct NothrowHash {
+    std::size_t operator()(int key) const noexcept { return key; }
+};
+struct NothrowEq {
+    bool operator()(int a, int b) const noexcept { return a == b; }
+};
+struct ThrowingHash {
+    std::size_t operator()(int key) const { return key; }
+};
+using NothrowMap = FlatMap<int, int, NothrowHash, NothrowEq>;
+using ThrowingMap = FlatMap<int, int, ThrowingHash, NothrowEq>;
+static_assert(noexcept(std::declval<const NothrowMap&>().contains(1)));
+static_assert(noexcept(std::declval<NothrowMap&>().find(1)));
+static_assert(!noexcept(std::declval<ThrowingMap&>().find(1)));
+static_assert(!noexcept(std::declval<const ThrowingMap&>().contains(1)));
+
+void test_flat_map_basic() {
+    std::cout << "test_flat_map_basic\n";
+    FlatMap<std::string, int> map;
+    std::cout << "empty find: " << map.find("a").is_some() << "\n";
+
+    auto inserted = map.insert("a", 1);
+    std::cout << "inserted new: " << inserted.is_ok() << "\n";
+    auto again = map.insert("a", 2);
+    std::cout << "inserted existing: " << again.is_ok()
+              << " value: " << again.unwrap_err().get() << "\n";
+    again.unwrap_err().get() = 10;
+
+    std::cout << "find: " << map.find("a").unwrap().get() << "\n";
+    std::cout << "missing: " << map.find("b").is_some() << "\n";
+
+    auto removed = map.remove("a");
+    std::cout << "removed: " << removed.unwrap() << " size: " << map.size()
+              << "\n";
+    std::cout << "removed again: " << map.remove("a").is_some() << "\n";
+}
+
+// Random inserts and removes against std::unordered_map
+void test_flat_map_random() {
+    std::cout << "test_flat_map_random\n";
+    FlatMap<std::uint64_t, std::unique_ptr<std::uint64_t>> map;
+    std::unordered_map<std::uint64_t, std::uint64_t> reference;
+    std::mt19937_64 gen(7);
+
+    bool all_match = true;
+    for (std::size_t i = 0; i < 200000; ++i) {
+        // small key space: plenty of hits, misses and tombstones
+        const std::uint64_t key = gen() % 5000 * 64;
+        if (gen() % 3 == 0) {
+            auto removed = map.remove(key);
+            const auto it = reference.find(key);
+            all_match =
+                all_match && removed.is_some() == (it != reference.end());
+            if (it != reference.end()) {
+                all_match = all_match && *removed.unwrap() == it->second;
+                reference.erase(it);
+            }
+        } else {
+            auto inserted =
+                map.insert(key, std::make_unique<std::uint64_t>(i));
+            const bool is_new = reference.emplace(key, i).second;
+            all_match = all_match && inserted.is_ok() == is_new;
+        }
+    }
+    for (const auto& [key, value] : reference) {
+        auto found = map.find(key);
+        all_match =
+            all_match && found.is_some() && *found.unwrap().get() == value;
+    }
+    std::size_t visited = 0;
+    map.for_each([&](std::uint64_t, const auto&) { ++visited; });
+    std::cout << "all match: " << all_match << "\n";
+    std::cout << "size matches: "
+              << (map.size() == reference.size() && visited == map.size())
+              << "\n";
+
+    FlatMap<std::uint64_t, int> copy;
+    copy.insert(1, 1);
+    auto copied = copy;
+    copied.insert(2, 2);
+    std::cout << "copies are independent: " << copy.size() << " "
+              << copied.size() << "\n";
+
+    map.clear();
+    std::cout << "cleared: " << map.size() << " "
+              << map.find(reference.begin()->first).is_some() << "\n";
+}
+
+// Throws on one armed key, so that a rehash fails half way
+struct ArmedHash {
+    static inline int armed = -1;
+
+    std::size_t operator()(int key) const {
+        if (key == armed) {
+            throw std::runtime_error("hash");
+        }
+        return key;
+    }
+};
+
+// Move may throw, so rehash copies; the copy throws when armed
+struct ArmedValue {
+    static inline bool armed = false;
+
+    explicit ArmedValue(int value) : value{value} {}
+    ArmedValue(const ArmedValue& other) : value{other.value} {
+        if (armed) {
+            throw std::runtime_error("copy");
+        }
+    }
+    ArmedValue(ArmedValue&& other) : ArmedValue(std::as_const(other)) {}
+
+    int value;
+};
+
+void test_flat_map_exceptions() {
+    std::cout << "test_flat_map_exceptions\n";
+    // 14 elements fill the first 16 slots: the next insert rehashes
+    FlatMap<int, int, ArmedHash> hashed;
+    FlatMap<int, ArmedValue> copied;
+    for (int i = 0; i < 14; ++i) {
+        hashed.insert(i, i);
+        copied.insert(i, i);
+    }
+
+    ArmedHash::armed = 3;
+    try {
+        hashed.insert(100, 100);
+    } catch (const std::runtime_error&) {
+        std::cout << "hash threw";
+    }
+    ArmedHash::armed = -1;
+    ArmedValue::armed = true;
+    try {
+        copied.insert(100, 100);
+    } catch (const std::runtime_error&) {
+        std::cout << ", copy threw";
+    }
+    ArmedValue::armed = false;
+
+    bool intact = hashed.size() == 14 && copied.size() == 14;
+    for (int i = 0; i < 14; ++i) {
+        intact = intact && hashed.find(i).unwrap().get() == i &&
+                 copied.find(i).unwrap().get().value == i;
+    }
+    std::cout << ", intact: " << intact << "\n";
+
+    // the argument refers into the map that is about to grow
+    FlatMap<int, std::string> names;
+    for (int i = 0; i < 14; ++i) {
+        names.insert(i, std::string(64, static_cast<char>('a' + i)));
+    }
+    names.insert(100, names.find(1).unwrap().get());
+    std::cout << "aliased insert: "
+              << (names.find(100).unwrap().get() == std::string(64, 'b'))
+              << " capacity: " << names.capacity() << "\n";
+}
+
+int main() {
+    test_flat_map_basic();
+    test_flat_map_random();
+    test_flat_map_exceptions();
+    return 0;
+}
@@ -0,0 +1,190 @@
+#include "hedge.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using better::CancelToken;
+using better::Err;
+using better::FakeClock;
+using better::Hedge;
+using better::ManualExecutor;
+using better::Ok;
+using better::Result;
+using better::ThreadPool;
+using namespace std::chrono_literals;
+
+using Lookup = Result<int, std::string>;
+
+void test_first_ok_manual() {
+    std::cout << "test_first_ok_manual\n";
+    ManualExecutor ex;
+    auto task = better::first_ok(
+        ex, [] { return Lookup{Err, "replica 0 miss"}; },
+        [] { return Lookup{Ok, 1}; }, [] { return Lookup{Ok, 2}; });
+    std::cout << "pending: " << ex.pending() << " ran: " << ex.run_all()
+              << "\n";
+    std::cout << "value: " << std::move(task).get().unwrap() << "\n";
+
+    auto all_fail = better::first_ok(
+        ex, [] { return Lookup{Err, "a"}; }, [] { return Lookup{Err, "b"}; });
+    ex.run_all();
+    auto errors = std::move(all_fail).get().unwrap_err();
+    std::cout << "errors:";
+    for (const auto& e : errors) {
+        std::cout << " " << e;
+    }
+    std::cout << "\n";
+
+    auto first_done = better::race(
+        ex, [] { return Lookup{Err, "fast failure"}; },
+        [] { return Lookup{Ok, 3}; });
+    ex.run_all();
+    std::cout << "race: " << std::move(first_done).get().unwrap_err() << "\n";
+}
+
+void test_hedge_fake_clock() {
+    std::cout << "test_hedge_fake_clock\n";
+    ManualExecutor ex;
+    FakeClock clock;
+    std::atomic<int> started = 0;
+
+    // primary is slow: the executor only gets to it after the hedge delay
+    auto task = better::first_ok(
+        ex, Hedge{clock, 10ms},
+        [&] {
+            ++started;
+            return Lookup{Err, "primary timed out"};
+        },
+        [&] {
+            ++started;
+            return Lookup{Ok, 7};
+        },
+        [&] {
+            ++started;
+            return Lookup{Ok, 8};
+        });
+    std::cout << "launched at start: " << ex.pending() << "\n";
+    std::cout << "after 5ms: " << clock.advance(5ms) << " timers\n";
+    std::cout << "after 10ms: " << clock.advance(5ms) << " timers, "
+              << ex.pending() << " jobs\n";
+    // primary fails and starts the third one at once, but the hedge
+    // answers first and the third one never calls its function
+    std::cout << "ran: " << ex.run_all() << "\n";
+    std::cout << "third timer is a no-op: " << clock.advance(10ms) << " "
+              << ex.pending() << "\n";
+    std::cout << "started: " << started.load()
+              << " value: " << std::move(task).get().unwrap() << "\n";
+
+    // failed primary does not wait for the hedge delay
+    started = 0;
+    auto failed = better::first_ok(
+        ex, Hedge{clock, 10ms},
+        [&] {
+            ++started;
+            return Lookup{Err, "connection refused"};
+        },
+        [&] {
+            ++started;
+            return Lookup{Ok, 9};
+        });
+    std::cout << "ran before delay: " << ex.run_all()
+              << " started: " << started.load()
+              << " value: " << std::move(failed).get().unwrap() << "\n";
+    std::cout << "late timer: " << clock.advance(10ms) << " "
+              << ex.pending() << "\n";
+
+    // primary answers in time: no hedge runs at all
+    auto fast = better::first_ok(
+        ex, Hedge{clock, 10ms}, [] { return Lookup{Ok, 1}; },
+        [&] {
+            ++started;
+            return Lookup{Ok, 2};
+        });
+    ex.run_all();
+    clock.advance(10ms);
+    ex.run_all();
+    std::cout << "hedge skipped: " << (started.load() == 2)
+              << " value: " << std::move(fast).get().unwrap() << "\n";
+}
+
+// A throwing callable still counts towards the race
+void test_throwing_callables() {
+    std::cout << "test_throwing_callables\n";
+    using Checked = Result<int, std::exception_ptr>;
+    ManualExecutor ex;
+    auto recovered = better::first_ok(
+        ex,
+        []() -> Checked { throw std::runtime_error("replica down"); },
+        [] { return Checked{Ok, 5}; });
+    ex.run_all();
+    std::cout << "value: " << std::move(recovered).get().unwrap() << "\n";
+
+    auto all_threw = better::first_ok(
+        ex, []() -> Checked { throw std::runtime_error("first"); },
+        []() -> Checked { throw std::runtime_error("second"); });
+    ex.run_all();
+    auto errors = std::move(all_threw).get().unwrap_err();
+    std::cout << "errors:";
+    for (const auto& e : errors) {
+        try {
+            std::rethrow_exception(e);
+        } catch (const std::runtime_error& error) {
+            std::cout << " " << error.what();
+        }
+    }
+    std::cout << "\n";
+}
+
+void test_cancel_thread_pool() {
+    std::cout << "test_cancel_thread_pool\n";
+    ThreadPool pool{2};
+    std::atomic<bool> loser_cancelled = false;
+    auto task = better::first_ok(
+        pool,
+        [&](CancelToken token) {
+            while (!token.is_cancelled()) {
+                std::this_thread::yield();
+            }
+            loser_cancelled = true;
+            return Lookup{Err, "cancelled"};
+        },
+        [] {
+            std::this_thread::sleep_for(1ms);
+            return Lookup{Ok, 42};
+        });
+    std::cout << "value: " << std::move(task).get().unwrap() << "\n";
+    while (!loser_cancelled.load()) {
+        std::this_thread::yield();
+    }
+    std::cout << "loser cancelled: " << loser_cancelled.load() << "\n";
+}
+
+void test_timer_thread() {
+    std::cout << "test_timer_thread\n";
+    better::TimerThread timer;
+    std::atomic<int> order = 0;
+    std::atomic<int> first = 0;
+    std::atomic<int> second = 0;
+    const auto now = timer.now();
+    timer.call_at(now + 2ms, [&] { second = ++order; });
+    timer.call_at(now + 1ms, [&] { first = ++order; });
+    while (order.load() < 2) {
+        std::this_thread::sleep_for(1ms);
+    }
+    std::cout << "fired in deadline order: "
+              << (first.load() == 1 && second.load() == 2) << "\n";
+}
+
+int main() {
+    test_first_ok_manual();
+    test_hedge_fake_clock();
+    test_throwing_callables();
+    test_cancel_thread_pool();
+    test_timer_thread();
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include "io.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using better::io::Bytes;
+using better::io::IoError;
+
+namespace io = better::io;
+
+std::string_view as_string(Bytes bytes) {
+    return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+}
+
+std::string make_temp_file(std::string_view content) {
+    char path[] = "/tmp/better_io_XXXXXX";
+    const int fd = ::mkstemp(path);
+    if (fd < 0 || ::write(fd, content.data(), content.size()) !=
+                      static_cast<ssize_t>(content.size())) {
+        std::cout << "cannot create temp file\n";
+        std::exit(1);
+    }
+    ::close(fd);
+    return path;
+}
+
+void test_map_file() {
+    std::cout << "test_map_file\n";
+    const auto path = make_temp_file("first record\nsecond record\n");
+
+    auto file = io::map_file(path.c_str()).unwrap();
+    std::cout << "size: " << file.size() << "\n";
+
+    auto record = file.read_at(13, 13);
+    // view points right into the mapping
+    std::cout << (record.unwrap().data() == file.bytes().data() + 13) << " "
+              << as_string(record.unwrap()) << "\n";
+
+    auto past_end = file.read_at(20, 100);
+    std::cout << "past end: " << past_end.unwrap_err().message() << "\n";
+
+    auto missing = io::map_file("/nonexistent/better_io");
+    std::cout << "missing: " << missing.unwrap_err().message() << "\n";
+
+    ::unlink(path.c_str());
+}
+
+void test_read_helpers() {
+    std::cout << "test_read_helpers\n";
+    const auto path = make_temp_file("0123456789abcdef");
+    const int fd = ::open(path.c_str(), O_RDONLY);
+
+    std::byte buf[4];
+    auto head = io::read_exact(fd, buf);
+    std::cout << (head.unwrap().data() == buf) << as_string(head.unwrap())
+              << "\n";
+
+    auto at = io::read_at(fd, 10, buf);
+    std::cout << as_string(at.unwrap()) << "\n";
+
+    auto eof = io::read_at(fd, 14, buf);
+    std::cout << "eof: " << (eof.unwrap_err().kind() ==
+                             IoError::Kind::UnexpectedEof)
+              << "\n";
+
+    std::byte a[3], b[5], c[100];
+    std::span<std::byte> bufs[] = {a, b, c};
+    auto filled = io::readv(fd, bufs).unwrap();
+    std::cout << "readv: " << filled.size();
+    for (Bytes view : filled) {
+        std::cout << " " << as_string(view);
+    }
+    // views point into the caller buffers, the last one is trimmed on EOF
+    std::cout << " " << (filled[2].data() == c) << filled[2].size() << "\n";
+
+    ::close(fd);
+    auto closed = io::read_exact(fd, buf);
+    std::cout << "closed: " << (closed.unwrap_err().code() == EBADF) << "\n";
+
+    ::unlink(path.c_str());
+}
+
+int main() {
+    test_map_file();
+    test_read_helpers();
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include "io.hpp"
+#include "offset_ref.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using better::None;
+using better::OffsetRef;
+using better::Option;
+using better::Some;
+
+struct Node {
+    std::uint64_t key = 0;
+    Option<OffsetRef<Node>> left = None;
+    Option<OffsetRef<Node>> right = None;
+};
+
+// Position-independent binary search tree in one flat region
+struct Index {
+    static constexpr std::size_t Capacity = 7;
+
+    Option<OffsetRef<Node>> root = None;
+    Node nodes[Capacity];
+};
+
+static_assert(sizeof(Option<OffsetRef<Node>>) == sizeof(std::int64_t));
+static_assert(sizeof(Option<Option<OffsetRef<Node, std::int32_t>>>) == 4);
+
+// Builds a balanced tree over keys 10, 20, ... 70 into raw memory
+Index* build(void* memory) {
+    auto* index = new (memory) Index{};
+    for (std::size_t i = 0; i < Index::Capacity; ++i) {
+        index->nodes[i].key = (i + 1) * 10;
+    }
+    auto link = [&](std::size_t parent, std::size_t left, std::size_t right) {
+        index->nodes[parent].left =
+            Option{Some, OffsetRef{index->nodes[left]}};
+        index->nodes[parent].right =
+            Option{Some, OffsetRef{index->nodes[right]}};
+    };
+    link(3, 1, 5);
+    link(1, 0, 2);
+    link(5, 4, 6);
+    index->root = Option{Some, OffsetRef{index->nodes[3]}};
+    return index;
+}
+
+bool contains(const Index& index, std::uint64_t key) {
+    auto node = index.root;
+    while (node.is_some()) {
+        const Node& current = node.unwrap();
+        if (current.key == key) {
+            return true;
+        }
+        node = key < current.key ? current.left : current.right;
+    }
+    return false;
+}
+
+void test_offset_ref_relocated() {
+    std::cout << "test_offset_ref_relocated\n";
+    alignas(Index) std::byte first[sizeof(Index)];
+    alignas(Index) std::byte second[sizeof(Index)];
+    build(first);
+
+    // bytewise copy to another address: no fix-up needed
+    std::memcpy(second, first, sizeof(Index));
+    std::memset(first, 0xAB, sizeof(Index));
+    const auto* moved = std::launder(reinterpret_cast<const Index*>(second));
+    std::cout << "contains 50: " << contains(*moved, 50)
+              << " contains 55: " << contains(*moved, 55) << "\n";
+
+    // C++ copies keep pointing at the same object
+    Node outside{1, None, None};
+    Option<OffsetRef<Node>> ref{Some, OffsetRef{outside}};
+    auto copy = ref;
+    copy.unwrap()->key = 2;
+    std::cout << "copy shares target: " << outside.key << "\n";
+
+    try {
+        struct SelfLoop {
+            Option<OffsetRef<SelfLoop>> self;
+        } loop{None};
+        loop.self = Option{Some, OffsetRef{loop}};
+    } catch (const std::invalid_argument& e) {
+        std::cout << "self loop: " << e.what() << "\n";
+    }
+}
+
+void test_offset_ref_mmap() {
+    std::cout << "test_offset_ref_mmap\n";
+    char path[] = "/tmp/better_offset_ref_XXXXXX";
+    const int fd = ::mkstemp(path);
+    if (fd < 0) {
+        std::cout << "cannot create temp file\n";
+        std::exit(1);
+    }
+    alignas(Index) std::byte memory[sizeof(Index)];
+    build(memory);
+    better::io::write_all_at(fd, 0, better::io::Bytes{memory, sizeof(memory)})
+        .unwrap();
+    ::close(fd);
+
+    auto file = better::io::map_file(path).unwrap();
+    const auto* index =
+        reinterpret_cast<const Index*>(file.bytes().data());
+    std::cout << "mapped at another address: "
+              << (static_cast<const void*>(index) !=
+                  static_cast<const void*>(memory))
+              << " contains 70: " << contains(*index, 70)
+              << " contains 0: " << contains(*index, 0) << "\n";
+    ::unlink(path);
+}
+
+int main() {
+    test_offset_ref_relocated();
+    test_offset_ref_mmap();
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include "oneshot.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+void test_oneshot_try_recv() {
+    std::cout << "test_oneshot_try_recv\n";
+    auto [tx, rx] = better::oneshot<std::unique_ptr<int>, std::string>();
+    std::cout << "before send: " << rx.try_recv().is_some() << "\n";
+    std::move(tx).send_ok(std::make_unique<int>(5));
+    auto received = rx.try_recv();
+    std::cout << "after send: " << *received.unwrap().unwrap() << "\n";
+    std::cout << "second recv: " << rx.try_recv().is_some()
+              << " closed: " << rx.is_closed() << "\n";
+}
+
+void test_oneshot_threads() {
+    std::cout << "test_oneshot_threads\n";
+    auto [tx, rx] = better::oneshot<int, std::string>();
+    std::thread sender([tx = std::move(tx)]() mutable {
+        std::this_thread::sleep_for(10ms);
+        std::move(tx).send_err("failed");
+    });
+    auto received = rx.recv();
+    std::cout << "received err: " << received.unwrap().unwrap_err() << "\n";
+    sender.join();
+}
+
+void test_oneshot_closed() {
+    std::cout << "test_oneshot_closed\n";
+    auto [tx, rx] = better::oneshot<int, int>();
+    std::thread dropper([tx = std::move(tx)]() mutable {
+        std::this_thread::sleep_for(10ms);
+        auto dropped = std::move(tx);
+    });
+    std::cout << "recv after drop: " << rx.recv().is_some() << "\n";
+    std::cout << "closed: " << rx.is_closed() << "\n";
+    dropper.join();
+}
+
+void test_oneshot_timeout() {
+    std::cout << "test_oneshot_timeout\n";
+    auto [tx, rx] = better::oneshot<int, int>();
+    const auto start = std::chrono::steady_clock::now();
+    std::cout << "timed out: " << rx.recv_for(20ms).is_none() << "\n";
+    std::cout << "waited: "
+              << (std::chrono::steady_clock::now() - start >= 20ms) << "\n";
+
+    std::thread sender([tx = std::move(tx)]() mutable {
+        std::this_thread::sleep_for(10ms);
+        std::move(tx).send(better::Result<int, int>{better::Ok, 7});
+    });
+    std::cout << "in time: " << rx.recv_for(10s).unwrap().unwrap() << "\n";
+    sender.join();
+}
+
+void test_oneshot_unreceived() {
+    std::cout << "test_oneshot_unreceived\n";
+    auto value = std::make_shared<int>(1);
+    {
+        auto [tx, rx] = better::oneshot<std::shared_ptr<int>, int>();
+        std::move(tx).send_ok(value);
+        std::cout << "owners in channel: " << value.use_count() << "\n";
+    }
+    std::cout << "owners after drop: " << value.use_count() << "\n";
+}
+
+int main() {
+    test_oneshot_try_recv();
+    test_oneshot_threads();
+    test_oneshot_closed();
+    test_oneshot_timeout();
+    test_oneshot_unreceived();
+    return 0;
+}
@@ -1,6 +1,11 @@
 #include "option.hpp"
+#include "relocate.hpp"
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -9,6 +14,44 @@ using better::Option;
 using better::Ref;
 using better::Some;
 
+// Header with a reserved byte that is never 0xFF on the wire
+struct PacketHeader {
+    uint32_t id;
+    uint8_t kind;
+    uint8_t reserved;
+    uint16_t len;
+};
+
+template <>
+struct better::option_flag_traits<PacketHeader> {
+    static void set_none(std::byte* bytes) noexcept {
+        bytes[offsetof(PacketHeader, reserved)] = std::byte{0xFF};
+    }
+    static bool is_none(const std::byte* bytes) noexcept {
+        return bytes[offsetof(PacketHeader, reserved)] == std::byte{0xFF};
+    }
+};
+
+// Non trivial payload: generation is never negative
+struct Handle {
+    int32_t generation;
+    std::unique_ptr<std::string> data;
+};
+
+template <>
+struct better::option_flag_traits<Handle> {
+    // generation is the first member
+    static void set_none(std::byte* bytes) noexcept {
+        const int32_t none = -1;
+        std::memcpy(bytes, &none, sizeof(none));
+    }
+    static bool is_none(const std::byte* bytes) noexcept {
+        int32_t generation;
+        std::memcpy(&generation, bytes, sizeof(generation));
+        return generation < 0;
+    }
+};
+
 void test_take_and_insert() {
     std::cout << "test take and insert\n";
     Option<std::vector<int>> opt_v = None;
@@ -35,9 +78,123 @@ void test_compare() {
     std::cout << (a > b) << "\n";
 }
 
+void test_relocate() {
+    std::cout << "test relocate\n";
+    static_assert(better::is_trivially_relocatable_v<Option<int>>);
+    static_assert(
+        better::is_trivially_relocatable_v<Option<std::unique_ptr<int>>>);
+    static_assert(!better::is_trivially_relocatable_v<Option<std::string>>);
+
+    using Elem = Option<std::unique_ptr<int>>;
+    alignas(Elem) std::byte src_buf[3 * sizeof(Elem)];
+    alignas(Elem) std::byte dst_buf[3 * sizeof(Elem)];
+    auto src = reinterpret_cast<Elem*>(src_buf);
+    auto dst = reinterpret_cast<Elem*>(dst_buf);
+
+    new (src) Elem{Some, std::make_unique<int>(1)};
+    new (src + 1) Elem{None};
+    new (src + 2) Elem{Some, std::make_unique<int>(3)};
+
+    auto end = better::uninitialized_relocate(src, src + 3, dst);
+    std::cout << (end - dst) << " " << *dst[0].unwrap() << " "
+              << dst[1].is_some() << " " << *dst[2].unwrap() << "\n";
+
+    // compaction: drop the None in the middle
+    std::destroy_at(dst + 1);
+    better::relocate_n(dst + 2, 1, dst + 1);
+    std::cout << *dst[1].unwrap() << "\n";
+    std::destroy_n(dst, 2);
+
+    // non trivially relocatable payload goes through move + destroy
+    using StrElem = Option<std::string>;
+    alignas(StrElem) std::byte str_src_buf[sizeof(StrElem)];
+    alignas(StrElem) std::byte str_dst_buf[sizeof(StrElem)];
+    auto str_src = new (str_src_buf) StrElem{Some, "relocated by move"};
+    auto str_dst = better::relocate_at(
+        str_src, reinterpret_cast<StrElem*>(str_dst_buf));
+    std::cout << str_dst->unwrap() << "\n";
+    std::destroy_at(str_dst);
+}
+
+void test_option_flag_traits() {
+    std::cout << "test option_flag_traits\n";
+    static_assert(sizeof(Option<PacketHeader>) == sizeof(PacketHeader));
+    static_assert(sizeof(Option<Handle>) == sizeof(Handle));
+
+    Option<PacketHeader> header = None;
+    std::cout << header.is_some();
+    header = Option<PacketHeader>{Some, PacketHeader{1, 2, 0, 3}};
+    std::cout << header.is_some() << header.unwrap().len << "\n";
+
+    Option<Handle> handle = {
+        Some, Handle{1, std::make_unique<std::string>("handle")}};
+    Option<Handle> empty = None;
+    handle.swap(empty);
+    std::cout << handle.is_some() << empty.is_some() << "\n";
+    auto copy = empty.take();
+    std::cout << empty.is_some() << *copy.unwrap().data << "\n";
+}
+
+void test_nested_niche() {
+    std::cout << "test nested niche\n";
+    static_assert(sizeof(Option<bool>) == sizeof(bool));
+    static_assert(sizeof(Option<Option<int>>) == sizeof(Option<int>));
+    static_assert(sizeof(Option<Option<Ref<int>>>) == sizeof(int*));
+    static_assert(sizeof(Option<Option<std::string>>) ==
+                  sizeof(Option<std::string>));
+
+    Option<bool> flag = None;
+    std::cout << flag.is_some();
+    flag.insert(false);
+    std::cout << flag.is_some() << flag.unwrap() << "\n";
+
+    using TriState = Option<Option<std::string>>;
+    TriState unset = None;
+    TriState cleared = {Some, None};
+    TriState set = {Some, Option<std::string>{Some, "value"}};
+    std::cout << unset.is_some() << cleared.is_some() << set.is_some() << "\n";
+
+    // flatten returns inner Option in place
+    const Option<std::string>& inner = set.flatten();
+    std::cout << (&inner == &set.unwrap()) << inner.unwrap() << "\n";
+    std::cout << unset.flatten().is_some() << cleared.flatten().is_some()
+              << "\n";
+
+    unset.swap(set);
+    auto copy = unset;
+    std::cout << set.is_some() << copy.is_some()
+              << std::move(copy).flatten().unwrap() << "\n";
+}
+
+enum class Status : uint8_t { Ok, NotFound, Timeout, _better_none };
+
+enum class Color : uint8_t { Red, Green, Blue };
+
+template <>
+struct better::enum_max<Color> {
+    static constexpr Color value = Color::Blue;
+};
+
+void test_enum_niche() {
+    std::cout << "test enum niche\n";
+    static_assert(sizeof(Option<Status>) == sizeof(Status));
+    static_assert(sizeof(Option<Color>) == sizeof(Color));
+
+    Option<Status> status = None;
+    Option<Color> color = {Some, Color::Blue};
+    std::cout << status.is_some() << color.is_some()
+              << (color.unwrap() == Color::Blue) << "\n";
+    status.insert(Status::Timeout);
+    std::cout << status.is_some() << "\n";
+}
+
 int main() {
     test_compare();
+    test_enum_niche();
+    test_nested_niche();
+    test_option_flag_traits();
     test_take_and_insert();
+    test_relocate();
 
     Option<std::string> opt = {Some, "hello world"};
 
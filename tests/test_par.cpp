@@ -0,0 +1,198 @@
+#include "par.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using better::Err;
+using better::None;
+using better::Ok;
+using better::Option;
+using better::Result;
+using better::Some;
+using better::Void;
+namespace par = better::par;
+
+void test_deque() {
+    std::cout << "test_deque\n";
+    par::detail::ChaseLevDeque deque;
+    for (std::uint64_t i = 0; i < 3; ++i) {
+        deque.push(i);
+    }
+    std::cout << "steal oldest: " << deque.steal().unwrap()
+              << " pop newest: " << deque.pop().unwrap()
+              << " then: " << deque.pop().unwrap()
+              << " empty: " << deque.pop().is_none() << "\n";
+
+    // owner pops while thieves steal: every item is taken exactly once
+    const std::uint64_t N = 100000;
+    std::atomic<std::uint64_t> sum = 0;
+    std::atomic<std::uint64_t> taken = 0;
+    std::atomic<bool> done = false;
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < 3; ++t) {
+        thieves.emplace_back([&] {
+            while (!done.load()) {
+                auto item = deque.steal();
+                if (item.is_some()) {
+                    sum += item.unwrap();
+                    ++taken;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    std::uint64_t own_sum = 0;
+    std::uint64_t own_taken = 0;
+    for (std::uint64_t i = 1; i <= N; ++i) {
+        while (!deque.push(i)) {
+            auto item = deque.pop();
+            if (item.is_some()) {
+                own_sum += item.unwrap();
+                ++own_taken;
+            }
+        }
+        if (i % 3 == 0) {
+            auto item = deque.pop();
+            if (item.is_some()) {
+                own_sum += item.unwrap();
+                ++own_taken;
+            }
+        }
+    }
+    while (taken.load() + own_taken < N) {
+        auto item = deque.pop();
+        if (item.is_some()) {
+            own_sum += item.unwrap();
+            ++own_taken;
+        }
+    }
+    done = true;
+    for (auto& thief : thieves) {
+        thief.join();
+    }
+    std::cout << "taken once: "
+              << (sum.load() + own_sum == N * (N + 1) / 2) << "\n";
+}
+
+void test_map(par::Pool& pool) {
+    std::cout << "test_map\n";
+    std::vector<int> input(100000);
+    std::iota(input.begin(), input.end(), 0);
+
+    auto squares = par::par_map(pool, input, [](int x) {
+        return std::int64_t{x} * x;
+    });
+    bool in_order = squares.size() == input.size();
+    for (std::size_t i = 0; i < squares.size(); ++i) {
+        in_order = in_order && squares[i] == std::int64_t(i) * std::int64_t(i);
+    }
+    std::cout << "in order: " << in_order << "\n";
+
+    // move-only results and void functions
+    auto boxes = par::par_map(pool, input, [](int x) {
+        return std::make_unique<int>(x);
+    });
+    std::atomic<int> calls = 0;
+    std::vector<Void> voids =
+        par::par_map(pool, input, [&](int) { ++calls; });
+    std::cout << "boxes: " << *boxes.back() << " voids: " << voids.size()
+              << " calls: " << calls.load() << "\n";
+
+    auto empty = par::par_map(pool, std::vector<int>{}, [](int x) { return x; });
+    std::cout << "empty: " << empty.size() << "\n";
+}
+
+void test_filter_map(par::Pool& pool) {
+    std::cout << "test_filter_map\n";
+    std::vector<int> input(100000);
+    std::iota(input.begin(), input.end(), 0);
+    auto every_7th = [](int x) -> Option<int> {
+        if (x % 7 == 0) {
+            return {Some, x};
+        }
+        return None;
+    };
+
+    auto ordered = par::par_filter_map(pool, input, every_7th);
+    std::cout << "count: " << ordered.size() << " sorted: "
+              << std::is_sorted(ordered.begin(), ordered.end()) << "\n";
+
+    auto any = par::par_filter_map(pool, input, every_7th, par::Order::Any);
+    std::sort(any.begin(), any.end());
+    std::cout << "same set: " << (any == ordered) << "\n";
+}
+
+void test_try_for_each(par::Pool& pool) {
+    std::cout << "test_try_for_each\n";
+    std::vector<int> input(1000000);
+    std::iota(input.begin(), input.end(), 0);
+
+    std::atomic<std::int64_t> sum = 0;
+    auto all = par::par_try_for_each(pool, input,
+                                     [&](int x) -> Result<Void, int> {
+                                         sum += x;
+                                         return {Ok};
+                                     });
+    std::cout << "all ok: " << all.is_ok()
+              << " sum: " << sum.load() << "\n";
+
+    std::atomic<int> visited = 0;
+    auto failed = par::par_try_for_each(
+        pool, input, [&](int x) -> Result<Void, int> {
+            ++visited;
+            if (x == 1000) {
+                return {Err, x};
+            }
+            return {Ok};
+        });
+    std::cout << "err: " << failed.unwrap_err() << " short-circuited: "
+              << (visited.load() < static_cast<int>(input.size())) << "\n";
+}
+
+void test_exceptions_and_nesting(par::Pool& pool) {
+    std::cout << "test_exceptions_and_nesting\n";
+    std::vector<int> input(10000);
+    std::iota(input.begin(), input.end(), 0);
+    try {
+        par::par_map(pool, input, [](int x) {
+            if (x == 5000) {
+                throw std::runtime_error("element 5000");
+            }
+            return x;
+        });
+    } catch (const std::runtime_error& e) {
+        std::cout << "caught: " << e.what() << "\n";
+    }
+
+    // inner loops run sequentially on the thread that runs the outer one
+    std::vector<int> rows(64);
+    std::iota(rows.begin(), rows.end(), 0);
+    auto sums = par::par_map(pool, rows, [&](int row) {
+        auto cells = par::par_map(pool, input, [&](int x) { return x + row; });
+        return std::accumulate(cells.begin(), cells.end(), std::int64_t{0});
+    });
+    std::cout << "nested: " << sums[0] << " " << sums[63] << "\n";
+}
+
+int main() {
+    test_deque();
+    // more threads than cores is fine: stealing still has to work
+    par::Pool pool{3};
+    test_map(pool);
+    test_filter_map(pool);
+    test_try_for_each(pool);
+    test_exceptions_and_nesting(pool);
+
+    std::vector<int> small{1, 2, 3};
+    auto doubled = par::par_map(small, [](int x) { return x * 2; });
+    std::cout << "default pool: " << doubled[2] << "\n";
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include "queue.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using better::MpmcQueue;
+using better::SpscQueue;
+
+void test_queue_bounds() {
+    std::cout << "test_queue_bounds\n";
+    MpmcQueue<std::unique_ptr<int>> queue{3};
+    std::cout << "capacity: " << queue.capacity() << "\n";
+    for (int i = 0; i < 4; ++i) {
+        queue.try_push(std::make_unique<int>(i)).unwrap();
+    }
+    auto full = queue.try_push(std::make_unique<int>(42));
+    std::cout << "full gives value back: " << *full.unwrap_err() << "\n";
+
+    std::cout << "popped:";
+    while (auto value = queue.try_pop()) {
+        std::cout << " " << *value.unwrap();
+    }
+    std::cout << "\n";
+
+    SpscQueue<std::unique_ptr<int>> spsc{2};
+    spsc.try_push(std::make_unique<int>(1)).unwrap();
+    spsc.try_push(std::make_unique<int>(2)).unwrap();
+    std::cout << "spsc full: " << spsc.try_push(nullptr).is_err()
+              << " first: " << *spsc.try_pop().unwrap() << "\n";
+    // one element is left for the destructor
+}
+
+void test_mpmc_threads() {
+    std::cout << "test_mpmc_threads\n";
+    const int Producers = 4;
+    const int Consumers = 4;
+    const std::uint64_t PerProducer = 50000;
+    MpmcQueue<std::uint64_t> queue{1024};
+
+    std::atomic<std::uint64_t> sum = 0;
+    std::atomic<std::uint64_t> count = 0;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < Producers; ++p) {
+        threads.emplace_back([&] {
+            for (std::uint64_t i = 1; i <= PerProducer; ++i) {
+                while (queue.try_push(i).is_err()) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (int c = 0; c < Consumers; ++c) {
+        threads.emplace_back([&] {
+            while (count.load() < Producers * PerProducer) {
+                auto value = queue.try_pop();
+                if (value.is_some()) {
+                    sum += value.unwrap();
+                    ++count;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    std::cout << "count: " << count.load() << " sum matches: "
+              << (sum.load() == Producers * PerProducer * (PerProducer + 1) / 2)
+              << "\n";
+}
+
+void test_spsc_order() {
+    std::cout << "test_spsc_order\n";
+    const std::uint64_t N = 200000;
+    SpscQueue<std::uint64_t> queue{256};
+
+    std::thread producer([&] {
+        for (std::uint64_t i = 0; i < N; ++i) {
+            while (queue.try_push(i).is_err()) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    bool in_order = true;
+    for (std::uint64_t expected = 0; expected < N;) {
+        auto value = queue.try_pop();
+        if (value.is_some()) {
+            in_order = in_order && value.unwrap() == expected;
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    std::cout << "in order: " << in_order
+              << " empty: " << queue.try_pop().is_none() << "\n";
+}
+
+int main() {
+    test_queue_bounds();
+    test_mpmc_threads();
+    test_spsc_order();
+    return 0;
+}
@@ -0,0 +1,156 @@
+#include "rc.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using better::Arc;
+using better::None;
+using better::Option;
+using better::Rc;
+using better::RcWeak;
+using better::Some;
+
+static_assert(sizeof(Rc<std::string>) == sizeof(void*));
+static_assert(sizeof(Option<Arc<std::string>>) == sizeof(void*));
+static_assert(sizeof(Option<Option<Arc<int>>>) == sizeof(void*));
+static_assert(sizeof(Option<Arc<int, RcWeak::Enabled>>) == sizeof(void*));
+static_assert(better::is_trivially_relocatable_v<Option<Arc<int>>>);
+
+struct Payload {
+    static inline int alive = 0;
+
+    explicit Payload(std::string name) : name{std::move(name)} { ++alive; }
+    Payload(const Payload& other) : name{other.name} { ++alive; }
+    ~Payload() { --alive; }
+
+    std::string name;
+};
+
+void test_rc_counts() {
+    std::cout << "test_rc_counts\n";
+    {
+        auto first = better::make_rc<Payload>("config");
+        auto second = first;
+        std::cout << "use_count: " << first.use_count()
+                  << " same: " << first.ptr_eq(second)
+                  << " name: " << second->name << "\n";
+
+        Option<Rc<Payload>> maybe{Some, std::move(second)};
+        std::cout << "in option: " << maybe.unwrap()->name
+                  << " use_count: " << first.use_count() << "\n";
+        maybe = None;
+        std::cout << "after None: " << first.use_count() << "\n";
+
+        Option<Rc<Payload>> copied{Some, first};
+        Option<Rc<Payload>> copy_of_copy = copied;
+        Option<Rc<Payload>> moved = std::move(copied);
+        std::cout << "copies: " << first.use_count()
+                  << " moved-from is none: " << copied.is_none() << "\n";
+    }
+    std::cout << "alive: " << Payload::alive << "\n";
+}
+
+void test_make_mut() {
+    std::cout << "test_make_mut\n";
+    auto shared = better::make_arc<Payload>("v1");
+    auto snapshot = shared;
+
+    shared.make_mut().name = "v2";
+    std::cout << "detached: " << !shared.ptr_eq(snapshot)
+              << " snapshot: " << snapshot->name
+              << " shared: " << shared->name << "\n";
+
+    const Payload* before = &*shared;
+    shared.make_mut().name = "v3";
+    std::cout << "unique mutates in place: " << (before == &*shared)
+              << " value: " << shared->name << "\n";
+}
+
+void test_weak() {
+    std::cout << "test_weak\n";
+    auto strong = better::make_rc<Payload, RcWeak::Enabled>("cache");
+    auto weak = strong.downgrade();
+    std::cout << "upgrade: " << weak.upgrade().unwrap()->name << "\n";
+
+    // a live Weak forces make_mut to copy
+    auto copy = strong;
+    copy = better::make_rc<Payload, RcWeak::Enabled>("other");
+    const Payload* before = &*strong;
+    strong.make_mut();
+    std::cout << "copied for weak: " << (before != &*strong) << "\n";
+
+    strong = better::make_rc<Payload, RcWeak::Enabled>("replacement");
+    std::cout << "dead upgrade: " << weak.upgrade().is_none()
+              << " alive: " << Payload::alive << "\n";
+}
+
+void test_arc_threads() {
+    std::cout << "test_arc_threads\n";
+    {
+        auto shared = better::make_arc<Payload>("routes");
+        std::atomic<std::size_t> total = 0;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([shared, &total] {
+                for (int i = 0; i < 10000; ++i) {
+                    Option<Arc<Payload>> local{Some, shared};
+                    total += local.unwrap()->name.size();
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        std::cout << "total: " << total.load()
+                  << " use_count: " << shared.use_count() << "\n";
+    }
+    std::cout << "alive: " << Payload::alive << "\n";
+}
+
+struct Pair {
+    int first = 0;
+    int second = 0;
+};
+
+// make_mut must never write into an object another thread
+// reached through upgrade() or a fresh downgrade()
+void test_make_mut_vs_upgrade() {
+    std::cout << "test_make_mut_vs_upgrade\n";
+    std::size_t torn = 0;
+    for (int round = 0; round < 200; ++round) {
+        auto owner = better::make_arc<Pair, RcWeak::Enabled>();
+        auto weak = owner.downgrade();
+        std::thread reader([weak = std::move(weak), &torn] {
+            for (int i = 0; i < 200; ++i) {
+                auto strong = weak.upgrade();
+                if (strong.is_none()) {
+                    continue;
+                }
+                auto again = strong.unwrap().downgrade();
+                const Pair& pair = *strong.unwrap();
+                if (pair.first != pair.second) {
+                    ++torn;
+                }
+            }
+        });
+        for (int i = 1; i <= 200; ++i) {
+            Pair& pair = owner.make_mut();
+            pair.first = i;
+            pair.second = i;
+        }
+        reader.join();
+    }
+    std::cout << "torn: " << torn << "\n";
+}
+
+int main() {
+    test_rc_counts();
+    test_make_mut();
+    test_weak();
+    test_arc_threads();
+    test_make_mut_vs_upgrade();
+    return 0;
+}
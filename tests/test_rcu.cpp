@@ -0,0 +1,118 @@
+#include "rcu.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+using better::RcuSlot;
+
+// Counts live instances to check reclamation
+struct Table {
+    static inline std::atomic<int> alive = 0;
+
+    explicit Table(std::uint64_t version) : version{version} {
+        for (auto& route : routes) {
+            route = version;
+        }
+        ++alive;
+    }
+    Table(const Table& other) : Table{other.version} {}
+    ~Table() { --alive; }
+
+    bool consistent() const {
+        for (auto route : routes) {
+            if (route != version) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::uint64_t version;
+    std::uint64_t routes[8];
+};
+
+void test_rcu_basic() {
+    std::cout << "test_rcu_basic\n";
+    RcuSlot<std::string> slot;
+    std::cout << "empty: " << slot.read().is_none() << "\n";
+
+    slot.store("v1");
+    {
+        auto guard = slot.read();
+        slot.store("v2");
+        // the old value stays alive while the guard is pinned
+        std::cout << "pinned: " << *guard.get().unwrap()
+                  << " retired: " << slot.retired_count() << "\n";
+        auto nested = slot.read();
+        std::cout << "nested: " << *nested.get().unwrap() << "\n";
+    }
+    // no further writes: the reader side asks for reclamation itself
+    std::cout << "try_reclaim: " << slot.try_reclaim() << "\n";
+    slot.synchronize();
+    std::cout << "after unpin retired: " << slot.retired_count()
+              << " current: " << *slot.read().get().unwrap() << "\n";
+    static_assert(!std::is_move_constructible_v<better::RcuGuard<int>>);
+
+    slot.reset();
+    std::cout << "reset: " << slot.read().get().is_none() << "\n";
+}
+
+void test_rcu_threads() {
+    std::cout << "test_rcu_threads\n";
+    {
+        RcuSlot<Table> slot{Table{1}};
+        std::atomic<bool> stop = false;
+        std::atomic<bool> all_consistent = true;
+        std::atomic<std::uint64_t> reads = 0;
+
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 4; ++r) {
+            readers.emplace_back([&] {
+                std::uint64_t last = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    auto guard = slot.read();
+                    auto table = guard.get();
+                    if (table.is_some()) {
+                        const Table& t = table.unwrap();
+                        // versions never go back for one reader
+                        if (!t.consistent() || t.version < last) {
+                            all_consistent = false;
+                        }
+                        last = t.version;
+                    }
+                    reads.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+        for (std::uint64_t v = 2; v < 2000; ++v) {
+            if (v % 500 == 0) {
+                slot.reset();
+            } else {
+                slot.emplace(v);
+            }
+            if (v % 100 == 0) {
+                std::this_thread::yield();
+            }
+        }
+        stop = true;
+        for (auto& reader : readers) {
+            reader.join();
+        }
+        slot.synchronize();
+        std::cout << "consistent: " << all_consistent.load()
+                  << " reads: " << (reads.load() > 0)
+                  << " alive before drop: " << Table::alive.load() << "\n";
+    }
+    std::cout << "alive after drop: " << Table::alive.load() << "\n";
+}
+
+int main() {
+    test_rcu_basic();
+    test_rcu_threads();
+    return 0;
+}
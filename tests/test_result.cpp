@@ -2,6 +2,8 @@
 #include "result.hpp"
 #include "void.hpp"
 
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -14,6 +16,31 @@ using better::Result;
 using better::Some;
 using better::Void;
 
+// Timestamp in microseconds, negative values are impossible
+struct Timestamp {
+    int64_t micros;
+};
+
+template <>
+struct better::option_flag_traits<Timestamp> {
+    static void set_none(std::byte* bytes) noexcept {
+        new (bytes) Timestamp{-1};
+    }
+    static bool is_none(const std::byte* bytes) noexcept {
+        return reinterpret_cast<const Timestamp*>(bytes)->micros < 0;
+    }
+};
+
+void test_result_flag_traits() {
+    std::cout << "test_result_flag_traits\n";
+    static_assert(sizeof(Result<Timestamp, int>) == 2 * sizeof(Timestamp));
+
+    Result<Timestamp, int> ok = {Ok, Timestamp{42}};
+    Result<Timestamp, int> err = {Err, 5};
+    std::cout << ok.is_ok() << err.is_ok() << ok.unwrap().micros
+              << err.unwrap_err() << "\n";
+}
+
 void test_result_and_then() {
     std::cout << "test_result_and_then\n";
     Result<int, std::string> res = {Ok, 55};
@@ -64,11 +91,94 @@ void test_result_or_else() {
     std::cout << "ok_val: " << ok_x << "\n";
 }
 
+void test_result_void_layout() {
+    std::cout << "test_result_void_layout\n";
+    static_assert(sizeof(Result<Ref<int>, Void>) == sizeof(int*));
+    static_assert(sizeof(Result<Void, Ref<int>>) == sizeof(int*));
+    static_assert(sizeof(Result<Timestamp, Void>) == sizeof(Timestamp));
+    static_assert(sizeof(Result<std::string, Void>) ==
+                  sizeof(better::Option<std::string>));
+
+    Result<std::string, Void> ok = {Ok, "ok value"};
+    auto opt = std::move(ok).ok();
+    std::cout << opt.unwrap() << "\n";
+
+    Result<std::string, Void> from_opt{std::move(opt)};
+    std::cout << from_opt.is_ok() << from_opt.unwrap() << "\n";
+
+    Result<Void, std::string> err = {Err, "err value"};
+    std::cout << err.is_err() << err.err().unwrap() << "\n";
+
+    Result<Void, std::string> from_none{better::Option<std::string>{None}};
+    std::cout << from_none.is_ok() << "\n";
+}
+
+void test_result_ok_err_ref() {
+    std::cout << "test_result_ok_err_ref\n";
+    const Result<std::string, std::string> ok = {Ok, "ok value"};
+    Result<std::string, std::string> err = {Err, "err value"};
+
+    auto ok_ref = ok.ok_ref();
+    static_assert(std::is_same_v<decltype(ok_ref),
+                                 better::Option<Ref<const std::string>>>);
+    static_assert(sizeof(ok_ref) == sizeof(void*));
+    std::cout << ok_ref.is_some() << ok.err_ref().is_some() << "\n";
+    ok_ref.map([](const std::string& s) { std::cout << s << "\n"; });
+
+    err.err_ref().map([](std::string& s) { s += "!"; });
+    std::cout << err.unwrap_err() << "\n";
+
+    // as_ref is already two pointers without a separate flag:
+    // null Ok pointer marks Err
+    static_assert(sizeof(ok.as_ref()) == 2 * sizeof(void*));
+}
+
+void test_option_of_result_niche() {
+    std::cout << "test_option_of_result_niche\n";
+    using R = Result<int, std::string>;
+    static_assert(sizeof(better::Option<R>) == sizeof(R));
+    static_assert(sizeof(better::Option<Result<Ref<int>, Void>>) ==
+                  sizeof(int*));
+
+    better::Option<R> none = None;
+    better::Option<R> err = {Some, R{Err, "error"}};
+    auto copy = err;
+    std::cout << none.is_some() << copy.is_some()
+              << copy.unwrap().unwrap_err() << "\n";
+}
+
+enum class Errc : uint8_t { Io, Parse, Timeout };
+
+template <>
+struct better::enum_max<Errc> {
+    static constexpr Errc value = Errc::Timeout;
+};
+
+void test_result_enum_error() {
+    std::cout << "test_result_enum_error\n";
+    static_assert(sizeof(Result<Void, Errc>) == sizeof(Errc));
+    static_assert(sizeof(Result<uint32_t, Errc>) == 2 * sizeof(uint32_t));
+
+    Result<std::string, Errc> ok = {Ok, "parsed"};
+    Result<std::string, Errc> err = {Err, Errc::Parse};
+    ok.swap(err);
+    std::cout << ok.is_ok() << err.unwrap() << (ok.unwrap_err() == Errc::Parse)
+              << "\n";
+
+    Result<Void, Errc> status = {Err, Errc::Io};
+    std::cout << status.is_err() << "\n";
+}
+
 int main() {
 
     test_result_and_then();
     test_result_or_else();
     test_result_map_or_else();
+    test_result_flag_traits();
+    test_result_void_layout();
+    test_result_ok_err_ref();
+    test_option_of_result_niche();
+    test_result_enum_error();
 
 
     Result<int, std::string> res = {Ok, 55};
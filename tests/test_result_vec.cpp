@@ -0,0 +1,149 @@
+#include "result_vec.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+using better::Err;
+using better::Ok;
+using better::Result;
+using better::ResultVec;
+
+using ParseResults = ResultVec<std::int64_t, std::string>;
+
+static_assert(std::forward_iterator<ParseResults::iterator>);
+static_assert(std::forward_iterator<ParseResults::const_iterator>);
+
+ParseResults make_results(std::size_t n) {
+    ParseResults results;
+    results.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (i % 1000 == 7) {
+            results.push_err("bad row " + std::to_string(i));
+        } else {
+            results.push_ok(static_cast<std::int64_t>(i));
+        }
+    }
+    return results;
+}
+
+void test_result_vec_access() {
+    std::cout << "test_result_vec_access\n";
+    auto results = make_results(10000);
+    std::cout << "size: " << results.size() << " oks: " << results.ok_count()
+              << " errors: " << results.error_count() << "\n";
+
+    bool all_match = true;
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        auto r = results[i];
+        if (i % 1000 == 7) {
+            all_match = all_match && r.is_err() &&
+                        r.unwrap_err().get() == "bad row " + std::to_string(i);
+        } else {
+            all_match = all_match && r.is_ok() &&
+                        r.unwrap().get() == static_cast<std::int64_t>(i);
+        }
+    }
+    std::cout << "random access matches: " << all_match << "\n";
+    std::cout << "out of range: " << results.get(10000).is_some() << "\n";
+
+    // values are mutable through references
+    results[8].unwrap().get() = -1;
+    results[7].unwrap_err().get() = "patched";
+    std::cout << "patched: " << results.oks()[7] << " "
+              << results.errors()[0].error << "\n";
+}
+
+void test_result_vec_views() {
+    std::cout << "test_result_vec_views\n";
+    const auto results = make_results(10000);
+
+    std::int64_t sum = 0;
+    for (auto x : results.oks()) {
+        sum += x;
+    }
+    std::cout << "oks sum: " << sum << "\n";
+
+    results.first_error().map([](const auto& e) {
+        std::cout << "first error at " << e.get().index << ": "
+                  << e.get().error << "\n";
+    });
+    std::cout << "error indices:";
+    for (const auto& e : results.errors()) {
+        std::cout << " " << e.index;
+    }
+    std::cout << "\n";
+
+    ParseResults clean;
+    clean.push(Result<std::int64_t, std::string>{Ok, 1});
+    std::cout << "clean has error: " << clean.first_error().is_some() << "\n";
+}
+
+void test_result_vec_iteration() {
+    std::cout << "test_result_vec_iteration\n";
+    const auto results = make_results(3000);
+
+    std::size_t index = 0;
+    bool all_match = true;
+    std::size_t errors = 0;
+    for (auto r : results) {
+        all_match = all_match && r.is_ok() == results.is_ok(index);
+        all_match = all_match && (r.is_err() || r.unwrap().get() ==
+                                                    static_cast<std::int64_t>(
+                                                        index));
+        errors += r.is_err();
+        ++index;
+    }
+    std::cout << "visited: " << index << " errors: " << errors
+              << " all match: " << all_match << "\n";
+}
+
+// Throws from the constructor on demand
+struct Fragile {
+    explicit Fragile(int value) : value{value} {
+        if (value < 0) {
+            throw std::runtime_error("fragile");
+        }
+    }
+
+    int value;
+};
+
+// A failed push at a bitmap word boundary must not shift later indices
+void test_result_vec_failed_push() {
+    std::cout << "test_result_vec_failed_push\n";
+    ResultVec<Fragile, Fragile> vec;
+    for (int i = 0; i < 64; ++i) {
+        vec.push_ok(i);
+    }
+    std::size_t failed = 0;
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        try {
+            vec.push_ok(-1);
+        } catch (const std::runtime_error&) {
+            ++failed;
+        }
+        try {
+            vec.push_err(-1);
+        } catch (const std::runtime_error&) {
+            ++failed;
+        }
+    }
+    vec.push_err(64);
+    vec.push_ok(65);
+    std::cout << "failed: " << failed << " size: " << vec.size()
+              << " oks: " << vec.ok_count() << " errors: " << vec.error_count()
+              << " [64]: " << vec[64].unwrap_err()->value
+              << " [65]: " << vec[65].unwrap()->value << "\n";
+}
+
+int main() {
+    test_result_vec_access();
+    test_result_vec_views();
+    test_result_vec_iteration();
+    test_result_vec_failed_push();
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include "slice.hpp"
+
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <span>
+#include <string>
+#include <vector>
+
+using better::IndexRange;
+using better::None;
+using better::Option;
+using better::Slice;
+using better::Some;
+
+static_assert(sizeof(Slice<int>) == 2 * sizeof(void*));
+static_assert(sizeof(Option<Slice<int>>) == 2 * sizeof(void*));
+static_assert(sizeof(Option<Option<Slice<int>>>) == 2 * sizeof(void*));
+static_assert(std::is_constructible_v<Slice<int>, std::vector<int>&>);
+static_assert(std::is_constructible_v<Slice<int>, std::span<int>>);
+static_assert(!std::is_constructible_v<Slice<int>, std::vector<int>&&>);
+static_assert(!std::is_constructible_v<Slice<int>, const std::vector<int>&>);
+static_assert(std::is_constructible_v<Slice<const int>, std::vector<int>&>);
+
+using Bytes = Slice<const std::uint8_t>;
+
+// Length-prefixed string: [len][len bytes]; None if the input is short
+Option<std::pair<std::string, Bytes>> parse_string(Bytes input) {
+    auto head = input.split_first();
+    if (head.is_none()) {
+        return None;
+    }
+    auto [len, rest] = head.unwrap();
+    auto parts = rest.split_at(len.get());
+    if (parts.is_none()) {
+        return None;
+    }
+    auto [body, tail] = parts.unwrap();
+    return {Some, std::string(body.begin(), body.end()), tail};
+}
+
+void test_slice_access() {
+    std::cout << "test_slice_access\n";
+    std::vector<int> values{1, 2, 3, 4, 5, 6, 7};
+    Slice all{values};
+
+    all.get(0).unwrap().get() = 10;
+    std::cout << "first: " << all.first().unwrap().get()
+              << " last: " << all.last().unwrap().get()
+              << " out of bounds: " << all.get(7).is_none() << "\n";
+
+    auto middle = all.get(IndexRange{2, 5}).unwrap();
+    std::cout << "middle:";
+    for (int x : middle) {
+        std::cout << " " << x;
+    }
+    std::cout << " bad range: " << all.get(IndexRange{5, 2}).is_none()
+              << " " << all.get(IndexRange{3, 8}).is_none() << "\n";
+
+    std::cout << "chunks of 3:";
+    for (std::size_t i = 0;; ++i) {
+        auto chunk = all.chunk(i, 3);
+        if (chunk.is_none()) {
+            break;
+        }
+        std::cout << " [" << chunk.unwrap().size() << "]";
+    }
+    std::cout << "\n";
+    // chunk size close to SIZE_MAX must not overflow into "no chunks"
+    std::cout << "one huge chunk: " << all.chunk(0, SIZE_MAX).unwrap().size()
+              << " " << all.chunk(1, SIZE_MAX).is_none() << "\n";
+
+    const Slice<int> frozen = all;
+    static_assert(
+        std::is_same_v<decltype(frozen.first().unwrap().get()), const int&>);
+    static_assert(std::is_same_v<decltype(frozen.chunk(0, 1)),
+                                 Option<Slice<const int>>>);
+
+    Slice<int> empty = all.get(IndexRange{7, 7}).unwrap();
+    std::array<int, 0> nothing{};
+    Slice<int> from_empty{nothing};
+    std::cout << "empty: " << empty.empty()
+              << " split_first: " << empty.split_first().is_none()
+              << " data not null: " << (from_empty.data() != nullptr) << "\n";
+
+    Option<Slice<int>> maybe = None;
+    Option<Option<Slice<int>>> nested{Some, maybe};
+    std::cout << "none: " << maybe.is_none()
+              << " some(empty) is some: "
+              << Option<Slice<int>>{Some, from_empty}.is_some()
+              << " nested some(none): " << nested.is_some() << "\n";
+}
+
+void test_slice_parse() {
+    std::cout << "test_slice_parse\n";
+    const std::vector<std::uint8_t> message{3, 'f', 'o', 'o', 2, 'h', 'i', 9,
+                                            'x'};
+    Bytes input{message};
+    while (true) {
+        auto parsed = parse_string(input);
+        if (parsed.is_none()) {
+            break;
+        }
+        auto [text, rest] = parsed.unwrap();
+        std::cout << "field: " << text << "\n";
+        input = rest;
+    }
+    std::cout << "truncated tail: " << input.size() << " bytes\n";
+}
+
+int main() {
+    test_slice_access();
+    test_slice_parse();
+    return 0;
+}
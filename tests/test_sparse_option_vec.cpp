@@ -0,0 +1,105 @@
+#include "sparse_option_vec.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+using better::None;
+using better::Option;
+using better::Some;
+using better::SparseOptionVec;
+
+static_assert(std::forward_iterator<SparseOptionVec<int>::iterator>);
+static_assert(std::forward_iterator<SparseOptionVec<int>::const_iterator>);
+
+// Fills sparse and plain vectors with the same values
+void fill(std::size_t n, const std::function<bool(std::size_t)>& is_some,
+          SparseOptionVec<std::uint64_t>& sparse,
+          std::vector<Option<std::uint64_t>>& plain) {
+    for (std::size_t i = 0; i < n; ++i) {
+        if (is_some(i)) {
+            sparse.push(Option<std::uint64_t>{Some, i * 3});
+            plain.emplace_back(Some, i * 3);
+        } else {
+            sparse.push_none();
+            plain.emplace_back(None);
+        }
+    }
+}
+
+bool same(const SparseOptionVec<std::uint64_t>& sparse,
+          const std::vector<Option<std::uint64_t>>& plain) {
+    if (sparse.size() != plain.size()) {
+        return false;
+    }
+    bool all_match = true;
+    for (std::size_t i = 0; i < plain.size(); ++i) {
+        auto value = sparse.get(i);
+        all_match = all_match && value.is_some() == plain[i].is_some();
+        all_match = all_match && (value.is_none() || value.unwrap().get() ==
+                                                         plain[i].unwrap());
+    }
+    std::size_t i = 0;
+    for (auto value : sparse) {
+        all_match = all_match && value.is_some() == plain[i].is_some();
+        all_match = all_match && (value.is_none() || value.unwrap().get() ==
+                                                         plain[i].unwrap());
+        ++i;
+    }
+    return all_match && i == plain.size() && sparse.get(i).is_none();
+}
+
+void test_sparse_containers() {
+    std::cout << "test_sparse_containers\n";
+    const std::size_t N = 300000;
+    std::mt19937 gen(42);
+
+    const std::pair<const char*, std::function<bool(std::size_t)>> patterns[] =
+        {
+            {"very sparse", [&](std::size_t) { return gen() % 1000 == 0; }},
+            {"half", [&](std::size_t) { return gen() % 2 == 0; }},
+            {"ranges", [](std::size_t i) { return i % 20000 < 5000; }},
+            {"all", [](std::size_t) { return true; }},
+            {"none", [](std::size_t) { return false; }},
+        };
+
+    for (const auto& [title, is_some] : patterns) {
+        SparseOptionVec<std::uint64_t> sparse;
+        std::vector<Option<std::uint64_t>> plain;
+        fill(N, is_some, sparse, plain);
+        const bool before = same(sparse, plain);
+        sparse.shrink_to_fit();
+        std::cout << title << ": match " << (before && same(sparse, plain))
+                  << ", present " << sparse.count_some()
+                  << ", memory " << sparse.memory_bytes() << " vs "
+                  << plain.size() * sizeof(plain[0]) << "\n";
+    }
+}
+
+void test_sparse_mutation() {
+    std::cout << "test_sparse_mutation\n";
+    SparseOptionVec<int> sparse;
+    sparse.push_none(1000000);
+    sparse.push_some(7);
+    sparse.push_none();
+    sparse.push_some(8);
+
+    sparse.get(1000000).unwrap().get() = 70;
+    std::cout << "size: " << sparse.size() << "\n";
+    std::cout << "values:";
+    for (int x : sparse.values()) {
+        std::cout << " " << x;
+    }
+    std::cout << "\n";
+    std::cout << "gap: " << sparse.get(1000001).is_some() << "\n";
+}
+
+int main() {
+    test_sparse_containers();
+    test_sparse_mutation();
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include "sys.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using better::Result;
+using better::Void;
+using better::sys::Errno;
+
+namespace sys = better::sys;
+
+void test_sys_layout() {
+    std::cout << "test_sys_layout\n";
+    static_assert(sizeof(sys::SysResult<std::size_t>) == sizeof(std::size_t));
+    static_assert(sizeof(sys::SysResult<ssize_t>) == sizeof(ssize_t));
+    static_assert(sizeof(sys::SysResult<void*>) == sizeof(void*));
+    static_assert(sizeof(Result<Void, Errno>) == sizeof(void*));
+    static_assert(sizeof(better::Option<Errno>) == sizeof(Errno));
+
+    // user Results keep the generic layout: -1 is a valid Ok value there
+    static_assert(sizeof(Result<long, Errno>) > sizeof(long));
+    Result<long, Errno> minus_one = {better::Ok, -1L};
+    Result<long, Errno> minus_max = {better::Ok, -4095L};
+    std::cout << minus_one.is_ok() << minus_max.is_ok() << minus_one.unwrap()
+              << "\n";
+
+    auto ok = sys::write(STDOUT_FILENO, "", 0);
+    auto err = sys::write(-1, "", 0);
+    std::cout << ok.is_ok() << err.is_err() << ok.unwrap()
+              << (err.unwrap_err().code() == EBADF) << "\n";
+    ok.swap(err);
+    std::cout << ok.is_err() << err.unwrap() << "\n";
+
+    // codes outside of [1, 4095] must not read back as Ok or None
+    sys::SysResult<std::size_t> zero = {better::Err, 0};
+    sys::SysResult<std::size_t> huge = {better::Err, 5000};
+    sys::SysResult<std::size_t> negative = {better::Err, -EBADF};
+    better::Option<Errno> some_zero = {better::Some, Errno{0}};
+    std::cout << zero.is_err() << huge.is_err() << negative.is_err()
+              << some_zero.is_some() << " "
+              << (zero.unwrap_err().code() == Errno::Unknown)
+              << (huge.unwrap_err().code() == Errno::Unknown) << "\n";
+    errno = 0;
+    std::cout << "last with errno 0: "
+              << (Errno::last().code() == Errno::Unknown) << "\n";
+}
+
+void test_sys_file_io() {
+    std::cout << "test_sys_file_io\n";
+    char path[] = "/tmp/better_sys_XXXXXX";
+    const int fd = ::mkstemp(path);
+    if (fd < 0) {
+        std::cout << "cannot create temp file\n";
+        std::exit(1);
+    }
+
+    const std::string payload = "hello syscalls";
+    auto written = sys::write(fd, payload.data(), payload.size());
+    std::cout << "written: " << written.unwrap() << "\n";
+
+    char buf[64] = {};
+    auto n = sys::pread(fd, buf, 5, 6).map([&](std::size_t n) {
+        return std::string(buf, n);
+    });
+    std::cout << "pread: " << n.unwrap() << "\n";
+
+    sys::pwrite(fd, "H", 1, 0).unwrap();
+    sys::close(fd).unwrap();
+
+    auto reopened = sys::open(path, O_RDONLY);
+    const int rfd = static_cast<int>(reopened.unwrap());
+    auto got = sys::read(rfd, buf, sizeof(buf));
+    std::cout << "read: " << std::string(buf, got.unwrap()) << "\n";
+
+    auto mapped = sys::mmap(nullptr, payload.size(), PROT_READ, MAP_PRIVATE,
+                            rfd, 0);
+    std::cout << "mmap: "
+              << std::string(static_cast<const char*>(mapped.unwrap().get()),
+                             payload.size())
+              << "\n";
+    sys::munmap(mapped.unwrap(), payload.size()).unwrap();
+    sys::close(rfd).unwrap();
+
+    // errors
+    auto bad_read = sys::read(rfd, buf, sizeof(buf));
+    std::cout << "read closed fd: " << (bad_read.unwrap_err().code() == EBADF)
+              << "\n";
+    auto bad_close = sys::close(rfd);
+    std::cout << "close closed fd: " << bad_close.unwrap_err().message()
+              << "\n";
+    auto bad_mmap =
+        sys::mmap(nullptr, payload.size(), PROT_READ, MAP_PRIVATE, rfd, 0);
+    std::cout << "mmap closed fd: " << (bad_mmap.unwrap_err().code() == EBADF)
+              << "\n";
+
+    ::unlink(path);
+    auto missing = sys::open(path, O_RDONLY);
+    std::cout << "open missing: " << (missing.unwrap_err().code() == ENOENT)
+              << "\n";
+}
+
+int main() {
+    test_sys_layout();
+    test_sys_file_io();
+    return 0;
+}
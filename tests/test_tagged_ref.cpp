@@ -0,0 +1,114 @@
+#include "tagged_ref.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using better::None;
+using better::Option;
+using better::Some;
+using better::TaggedRef;
+
+// Red-black tree node: the color lives in the parent link
+struct TreeNode {
+    enum Color : std::uintptr_t { Red = 0, Black = 1 };
+
+    int key;
+    Option<TaggedRef<TreeNode, 1>> parent = None;
+};
+
+static_assert(sizeof(TaggedRef<TreeNode, 1>) == sizeof(void*));
+static_assert(sizeof(Option<TaggedRef<TreeNode, 2>>) == sizeof(void*));
+static_assert(sizeof(Option<Option<TaggedRef<TreeNode, 2>>>) ==
+              sizeof(void*));
+static_assert(std::is_trivially_copyable_v<TaggedRef<TreeNode, 2>>);
+
+// bits past `Bits` do not compile
+template <class R, unsigned Bit>
+concept CanSetBit = requires(R r) { r.template set<Bit>(true); };
+
+void test_tagged_ref() {
+    std::cout << "test_tagged_ref\n";
+    TreeNode root{10};
+    TreeNode child{5};
+    child.parent = Option{Some, TaggedRef<TreeNode, 1>{root, TreeNode::Black}};
+
+    auto parent = child.parent.unwrap();
+    std::cout << "parent: " << parent->key << " color: " << parent.tag()
+              << "\n";
+    parent.set_tag(TreeNode::Red);
+    parent->key = 11;
+    std::cout << "recolored: " << parent.tag() << " key: " << root.key
+              << " same target: " << parent.ref_equals(child.parent.unwrap())
+              << " equal: " << (parent == child.parent.unwrap()) << "\n";
+
+    std::uint64_t word = 0;
+    TaggedRef<std::uint64_t, 3> flags{word};
+    flags.set<0>(true);
+    flags.set<2>(true);
+    flags.set<0>(false);
+    static_assert(CanSetBit<TaggedRef<std::uint64_t, 3>, 2>);
+    static_assert(!CanSetBit<TaggedRef<std::uint64_t, 3>, 3>);
+    const auto frozen = flags.with_tag(7);
+    static_assert(std::is_same_v<decltype(frozen.get()), const std::uint64_t&>);
+    TaggedRef<const std::uint64_t, 3> as_const = flags;
+    std::cout << "flags: " << flags.tag() << " bit 2: " << flags.test<2>()
+              << " with_tag: " << frozen.tag()
+              << " const keeps tag: " << as_const.tag() << "\n";
+
+    Option<TaggedRef<TreeNode, 1>> empty = None;
+    Option<Option<TaggedRef<TreeNode, 1>>> nested{Some, empty};
+    std::cout << "none: " << empty.is_none()
+              << " nested some(none): " << nested.is_some() << "\n";
+}
+
+// Lock-free stack whose head carries a "sealed" mark in the same word
+struct StackNode {
+    int value;
+    Option<TaggedRef<StackNode, 1>> next = None;
+};
+
+void test_atomic_tagged() {
+    std::cout << "test_atomic_tagged\n";
+    const int PerThread = 10000;
+    std::vector<StackNode> nodes(4 * PerThread);
+    StackNode sentinel{-1};
+    std::atomic<TaggedRef<StackNode, 1>> head{TaggedRef<StackNode, 1>{sentinel}};
+    static_assert(std::atomic<TaggedRef<StackNode, 1>>::is_always_lock_free);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < PerThread; ++i) {
+                auto& node = nodes[t * PerThread + i];
+                node.value = 1;
+                auto expected = head.load();
+                do {
+                    node.next = Option{Some, expected.with_tag(0)};
+                } while (!head.compare_exchange_weak(
+                    expected, TaggedRef<StackNode, 1>{node}));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    // seal: later pushes would fail their CAS on the marked word
+    auto top = head.load();
+    head.store(top.with_tag(1));
+
+    long sum = 0;
+    for (Option<TaggedRef<StackNode, 1>> node{Some, head.load()};
+         node.unwrap()->value != -1; node = node.unwrap()->next) {
+        sum += node.unwrap()->value;
+    }
+    std::cout << "pushed: " << sum << " sealed: " << head.load().tag() << "\n";
+}
+
+int main() {
+    test_tagged_ref();
+    test_atomic_tagged();
+    return 0;
+}
@@ -0,0 +1,177 @@
+#include "task.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+using better::Err;
+using better::ManualExecutor;
+using better::Ok;
+using better::Result;
+using better::Task;
+using better::ThreadPool;
+
+// Counts heap allocations to check what a pipeline stage costs
+static std::atomic<std::size_t> allocations = 0;
+
+void* operator new(std::size_t size) {
+    ++allocations;
+    if (void* p = std::malloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+using Job = better::Job;
+
+struct Big {
+    char data[256] = {};
+};
+
+static_assert(Job::IsInline<void (*)()>);
+static_assert(!Job::IsInline<Big>);
+
+void test_inline_function() {
+    std::cout << "test_inline_function\n";
+    int calls = 0;
+    const std::size_t before = allocations;
+    Job small = [&calls] { ++calls; };
+    Job moved = std::move(small);
+    moved();
+    std::cout << "small allocations: " << allocations - before
+              << " calls: " << calls << " moved from: " << bool(small)
+              << "\n";
+
+    Big big;
+    Job large = [big, &calls] { calls += big.data[0] + 1; };
+    Job large_moved = std::move(large);
+    large_moved();
+    std::cout << "large calls: " << calls << "\n";
+}
+
+void test_task_manual() {
+    std::cout << "test_task_manual\n";
+    ManualExecutor ex;
+    std::vector<std::string> log;
+
+    auto task = better::spawn(ex, [&] {
+                    log.push_back("spawn");
+                    return Result<int, std::string>{Ok, 4};
+                })
+                    .map(ex,
+                         [&](int x) {
+                             log.push_back("map");
+                             return x * 10;
+                         })
+                    .and_then(ex, [&](int x) {
+                        log.push_back("and_then");
+                        return Result<int, std::string>{
+                            Err, "too big: " + std::to_string(x)};
+                    });
+    auto after_err = std::move(task)
+                         .map(ex,
+                              [&](int x) {
+                                  log.push_back("skipped");
+                                  return x;
+                              })
+                         .map_err(ex, [&](std::string e) {
+                             log.push_back("map_err");
+                             return e.size();
+                         });
+
+    std::cout << "nothing ran yet: " << log.empty()
+              << " pending: " << ex.pending() << "\n";
+    ex.run_one();
+    std::cout << "after one step: " << log.size() << "\n";
+    std::cout << "jobs: " << 1 + ex.run_all() << "\n";
+    std::cout << "log:";
+    for (const auto& entry : log) {
+        std::cout << " " << entry;
+    }
+    std::cout << "\n";
+    std::cout << "error size: " << std::move(after_err).get().unwrap_err()
+              << "\n";
+}
+
+void test_task_stage_allocations() {
+    std::cout << "test_task_stage_allocations\n";
+    ManualExecutor ex;
+    auto [promise, task] = better::make_task<int, int>();
+
+    const std::size_t before = allocations;
+    auto next = std::move(task).map(ex, [](int x) { return x + 1; });
+    std::cout << "allocations per stage: " << allocations - before << "\n";
+
+    std::move(promise).set_ok(1);
+    ex.run_all();
+    std::cout << "value: " << std::move(next).get().unwrap() << "\n";
+
+    auto ready = Task<int, int>::ready(Result<int, int>{Ok, 5})
+                     .and_then([](int x) {
+                         return Task<int, int>::ready(
+                             Result<int, int>{Ok, x * 2});
+                     });
+    std::cout << "ready chain: " << std::move(ready).get().unwrap() << "\n";
+}
+
+struct Counted {
+    static inline int alive = 0;
+
+    Counted() { ++alive; }
+    Counted(const Counted&) { ++alive; }
+    ~Counted() { --alive; }
+};
+
+void test_task_dropped_job() {
+    std::cout << "test_task_dropped_job\n";
+    {
+        ManualExecutor ex;
+        auto [promise, task] = better::make_task<Counted, int>();
+        auto next = std::move(task).map(ex, [](const Counted&) { return 1; });
+        std::move(promise).set_ok();
+        std::cout << "pending: " << ex.pending()
+                  << " alive: " << Counted::alive << "\n";
+        // the executor goes away without running the job
+    }
+    std::cout << "alive after drop: " << Counted::alive << "\n";
+}
+
+void test_task_thread_pool() {
+    std::cout << "test_task_thread_pool\n";
+    ThreadPool pool{4};
+    const int N = 1000;
+    std::vector<Task<long, std::string>> tasks;
+    for (int i = 0; i < N; ++i) {
+        tasks.push_back(
+            better::spawn(pool, [i] { return Result<int, std::string>{Ok, i}; })
+                .and_then(pool,
+                          [&pool](int x) {
+                              // scheduled from a worker: lands on its queue
+                              return better::spawn(pool, [x] {
+                                  return Result<long, std::string>{Ok, 2L * x};
+                              });
+                          })
+                .map(pool, [](long x) { return x + 1; }));
+    }
+    long sum = 0;
+    for (auto& task : tasks) {
+        sum += std::move(task).get().unwrap();
+    }
+    std::cout << "sum: " << sum << "\n";
+}
+
+int main() {
+    test_inline_function();
+    test_task_manual();
+    test_task_stage_allocations();
+    test_task_dropped_job();
+    test_task_thread_pool();
+    return 0;
+}